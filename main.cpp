@@ -8,8 +8,10 @@
 #include "phase_one/creation/ToAutomaton.h"
 #include "phase_one/creation/LexicalRulesHandler.h"
 #include "phase_one/prediction/Predictor.h"
+#include "phase_one/prediction/TokenStreamFile.h"
 #include "phase_two/Table.h"
 #include "phase_two/Parser.h"
+#include "phase_two/ResultCache.h"
 
 LexicalRulesHandler handler;
 
@@ -22,15 +24,40 @@ std::string parsing_output_name = "parsing_output.txt";
 std::shared_ptr<Automaton>
 init(const std::string &input_file_path, const std::string &final_dfa_path, const std::string &tokens_priorities);
 
-void export_token_list_to_file(const std::vector<std::pair<std::string, std::string>> &token_list,
-                               const std::string &filename);
-
 int main(int argc, char *argv[]) {
     if (argc < 4) {
         std::cerr << "Usage: " << argv[0]
-                  << " <output_token_path> <input_program_path> <input_rules_path> <input_cfg_path>\n";// <data_directory_path>\n";
+                  << " <output_token_path> <input_program_path> <input_rules_path> <input_cfg_path> [--keyword-hash] [--directed-scanning]"
+                  << " [--diagnostics=console|none|<file>] [--binary-tokens]"
+                  << " [--cache=<directory>]\n";// <data_directory_path>\n";
         return 1;
     }
+    bool directed_scanning = false;
+    bool binary_tokens = false;
+    std::string cache_directory{};
+    std::string diagnostics_output = "console";
+    for (int i = 5; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--keyword-hash") {
+            // recognise the keywords an identifier rule matches with a perfect hash instead of DFA states
+            handler.set_keyword_hashing(true);
+        } else if (option == "--directed-scanning") {
+            // scan only the terminals the parser can accept at each step
+            directed_scanning = true;
+        } else if (option.rfind("--diagnostics=", 0) == 0) {
+            // where the lexical errors are written, all at once when the program is consumed
+            diagnostics_output = option.substr(14);
+        } else if (option == "--binary-tokens") {
+            // write every token with its position and lexeme to <output_token_path> (see TokenStreamFile.h)
+            binary_tokens = true;
+        } else if (option.rfind("--cache=", 0) == 0) {
+            // reuse the tokens and the parse of a program that was already run through the same lexer and grammar
+            cache_directory = option.substr(8);
+        } else {
+            std::cerr << "Unknown option: " << option << '\n';
+            return 1;
+        }
+    }
     // ############################## create export lexical data ##############################
 
     // files
@@ -57,33 +84,83 @@ int main(int argc, char *argv[]) {
     // import tokens priorities
     std::map<std::string, int> priorities = LexicalRulesHandler::import_priorities(tokens_priorities_path);
 
+    if (binary_tokens) {
+        Predictor predictor(loaded_automaton, priorities, input_program_path);
+        predictor.get_diagnostics().to_nothing();
+        TokenStreamWriter writer(output_token_path, predictor.get_token_table());
+        writer.write_all(predictor);
+        writer.close();
+    }
+
     // ############################## predicting tokens and parsing ##############################
     if (true) {
-        std::shared_ptr<Predictor> tokenizer = std::make_shared<Predictor>(loaded_automaton, priorities,
-                                                                           input_program_path);
-        std::shared_ptr<Table> parsing_table = std::make_shared<Table>(input_cfg_path, parsing_table_path);
-        std::shared_ptr<Parser> parser = std::make_shared<Parser>(parsing_table);
-        parser->parse(tokenizer, parsing_tree_path, parsing_output_path);
+        auto make_tokenizer = [&]() {
+            std::shared_ptr<Predictor> tokenizer = std::make_shared<Predictor>(loaded_automaton, priorities,
+                                                                               input_program_path);
+            if (diagnostics_output == "none") {
+                tokenizer->get_diagnostics().to_nothing();
+            } else if (diagnostics_output != "console") {
+                tokenizer->get_diagnostics().to_file(diagnostics_output);
+            }
+            return tokenizer;
+        };
+        // a program read from stdin has to be scanned anyway to be hashed, it isn't cached
+        if (cache_directory.empty() || input_program_path == "-") {
+            std::shared_ptr<Predictor> tokenizer = make_tokenizer();
+            std::shared_ptr<Table> parsing_table = std::make_shared<Table>(input_cfg_path, parsing_table_path);
+            std::shared_ptr<Parser> parser = std::make_shared<Parser>(parsing_table);
+            parser->set_directed_scanning(directed_scanning);
+            parser->parse(tokenizer, parsing_tree_path, parsing_output_path);
+        } else {
+            ResultCache cache(cache_directory);
+            std::string input_hash = ResultCache::hash_file(input_program_path);
+            // the lexer is the DFA and the priorities exported above, the parsing table is derived from the grammar
+            std::string lexer_hash = ResultCache::hash(Predictor::read_file(final_dfa_path) +
+                                                       Predictor::read_file(tokens_priorities_path));
+            std::string table_hash = ResultCache::hash(Predictor::read_file(input_cfg_path) +
+                                                       (directed_scanning ? "\n--directed-scanning" : ""));
+            std::shared_ptr<Table> parsing_table = std::make_shared<Table>(input_cfg_path, parsing_table_path);
+            std::shared_ptr<Parser> parser = std::make_shared<Parser>(parsing_table);
+            parser->set_directed_scanning(directed_scanning);
+            cache.parse(input_hash, lexer_hash, table_hash, parsing_tree_path, parsing_output_path,
+                        [&](const std::string &tree_path, const std::string &output_path) {
+                            if (directed_scanning) {
+                                // the tokens depend on the parser, they can only be scanned while parsing
+                                std::shared_ptr<Predictor> tokenizer = make_tokenizer();
+                                parser->parse(tokenizer, tree_path, output_path);
+                                return tokenizer->get_diagnostics().reported() == 0;
+                            }
+                            std::shared_ptr<Predictor> scanned{};
+                            std::shared_ptr<TokenStreamReader> tokens = cache.tokens(input_hash, lexer_hash, [&]() {
+                                scanned = make_tokenizer();
+                                return scanned;
+                            });
+                            parser->parse(*tokens, SourceBuffer::map_file(input_program_path), tree_path,
+                                          output_path);
+                            return !scanned || scanned->get_diagnostics().reported() == 0;
+                        });
+        }
     }
     else {
         // prediction
         Predictor predictor(loaded_automaton, priorities, input_program_path);
+        const TokenTable &token_table = predictor.get_token_table();
 
-        std::vector<std::pair<std::string, std::string >> token_list{};
+        std::ofstream token_file(output_token_path);
+        if (!token_file) {
+            throw std::runtime_error("Failed to open file: " + output_token_path);
+        }
         std::vector<std::string> tokens{};
         // ############################## predict tokens ##############################
         std::cout << "############################ Tokens ############################" << '\n';
-        while (true) {
-            std::pair<std::string, std::string> entry = predictor.next_token();
-            if (entry.first.empty() && entry.second.empty()) {
-                // if output is ("","") then we reached the end
-                break;
-            }
-            std::cout << entry.first << ": " << entry.second << std::endl;
-            token_list.push_back(entry);
-            tokens.push_back(entry.first);
+        // the tokens are written as they are scanned, the parser only needs their names
+        for (const Token &token: predictor.tokens()) {
+            const std::string &name = token_table.name(token.kind);
+            std::cout << name << ": " << predictor.lexeme(token) << '\n';
+            token_file << name << '\n';
+            tokens.push_back(name);
         }
-        export_token_list_to_file(token_list, output_token_path);
+        token_file.close();
         std::cout << "########################################################" << '\n';
 
         // ############################## load parser data ##############################
@@ -114,19 +191,3 @@ init(const std::string &input_file_path, const std::string &final_dfa_path, cons
     LexicalRulesHandler::export_priorities(handler.get_priorities(), tokens_priorities);
     return final_dfa;
 }
-
-
-void export_token_list_to_file(const std::vector<std::pair<std::string, std::string>> &token_list,
-                               const std::string &filename) {
-    std::ofstream outfile(filename);
-    if (!outfile) {
-        throw std::runtime_error("Failed to open file: " + filename);
-    }
-
-    for (const auto &pair: token_list) {
-        outfile << pair.first << '\n';
-    }
-
-    outfile.close();
-}
-
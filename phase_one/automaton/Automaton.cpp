@@ -6,6 +6,7 @@
 #include <fstream>
 #include <iterator>
 #include <regex>
+#include <limits>
 #include "Automaton.h"
 
 
@@ -268,6 +269,108 @@ Types::state_to_string_set_map_t Automaton::get_tokens() {
     return this->tokens;
 }
 
+void Automaton::resolve_winning_tokens(const std::map<std::string, int> &priorities) {
+    auto pick = [&priorities](const Types::string_set_t &candidates) {
+        int max_priority = std::numeric_limits<int>::min();
+        std::string chosen_token{};
+        for (const std::string &t: candidates) {
+            auto it = priorities.find(t);
+            if (it != priorities.end() && max_priority < it->second) {
+                max_priority = it->second;
+                chosen_token = t;
+            }
+        }
+        return chosen_token;
+    };
+    this->winning_tokens = {};
+    // walk the map instead of looking states up, its buckets may predate the last renumbering of the states
+    for (const auto &pair: this->tokens) {
+        std::string chosen_token = pick(pair.second);
+        if (!chosen_token.empty()) {
+            this->winning_tokens[pair.first] = chosen_token;
+        }
+    }
+    // accepting states without a token set report their own token
+    for (const std::shared_ptr<State> &state_ptr: this->accepting) {
+        if (this->winning_tokens.find(state_ptr) == this->winning_tokens.end()) {
+            std::string chosen_token = pick({state_ptr->getToken()});
+            if (!chosen_token.empty()) {
+                this->winning_tokens[state_ptr] = chosen_token;
+            }
+        }
+    }
+}
+
+std::string Automaton::get_winning_token(const std::shared_ptr<State> &state_ptr) {
+    auto it = this->winning_tokens.find(state_ptr);
+    if (it != this->winning_tokens.end()) {
+        return it->second;
+    }
+    return "";
+}
+
+void Automaton::set_winning_token(const std::shared_ptr<State> &state_ptr, const std::string &token) {
+    this->winning_tokens[state_ptr] = token;
+}
+
+const std::vector<std::string> &Automaton::get_hashed_keywords() {
+    return this->hashed_keywords;
+}
+
+void Automaton::set_hashed_keywords(const std::vector<std::string> &keywords) {
+    this->hashed_keywords = keywords;
+}
+
+const std::map<std::string, std::shared_ptr<Automaton>> &Automaton::get_modes() {
+    return this->modes;
+}
+
+void Automaton::add_mode(const std::string &mode, const std::shared_ptr<Automaton> &automaton) {
+    this->modes[mode] = automaton;
+}
+
+const std::map<std::string, std::string> &Automaton::get_mode_switches() {
+    return this->mode_switches;
+}
+
+void Automaton::set_mode_switch(const std::string &token, const std::string &mode) {
+    this->mode_switches[token] = mode;
+}
+
+const std::vector<std::string> &Automaton::get_skip_tokens() {
+    return this->skip_tokens;
+}
+
+void Automaton::set_skip_tokens(const std::vector<std::string> &tokens) {
+    this->skip_tokens = tokens;
+}
+
+std::string Automaton::escape_symbol(const std::string &symbol) {
+    if (symbol == " ") {
+        return "\\s";
+    } else if (symbol == "\t") {
+        return "\\t";
+    } else if (symbol == "\n") {
+        return "\\n";
+    } else if (symbol == "\r") {
+        return "\\r";
+    }
+    return symbol;
+}
+
+std::string Automaton::unescape_symbol(const std::string &symbol) {
+    if (symbol == "\\s") {
+        return " ";
+    } else if (symbol == "\\t") {
+        return "\t";
+    } else if (symbol == "\\n") {
+        return "\n";
+    } else if (symbol == "\\r") {
+        return "\r";
+    }
+    return symbol;
+}
+
 
 std::string Automaton::to_json() {
     std::ostringstream sb;
@@ -317,7 +420,7 @@ std::string Automaton::to_string() {
 
     ss << "Input Symbols: ";
     for (const auto &symbol: this->alphabets) {
-        ss << symbol << " ";
+        ss << escape_symbol(symbol) << " ";
     }
     ss << "\n";
 
@@ -343,7 +446,7 @@ std::string Automaton::to_string() {
 
 
     for (const auto &entry: sorted_transitions) {
-        ss << "f(" << entry.first.first->getId() << ", " << entry.first.second << ") = ";
+        ss << "f(" << entry.first.first->getId() << ", " << escape_symbol(entry.first.second) << ") = ";
         for (const auto &state: entry.second) {
             ss << state->getId() << " ";
         }
@@ -363,6 +466,43 @@ std::string Automaton::to_string() {
         ss << '\n';
     }
 
+    // add the token every accepting state reports (the empty line ends the Tokens section)
+    if (!this->winning_tokens.empty()) {
+        ss << "\nWinners:\n";
+        for (const auto &pair: this->winning_tokens) {
+            ss << pair.first->toString() << ": " << pair.second << '\n';
+        }
+    }
+
+    // add the keywords that are left to the perfect hash, one per line
+    if (!this->hashed_keywords.empty()) {
+        ss << "\nKeywords:\n";
+        for (const std::string &keyword: this->hashed_keywords) {
+            ss << keyword << '\n';
+        }
+    }
+
+    // add the tokens that are skipped, one per line
+    if (!this->skip_tokens.empty()) {
+        ss << "\nSkip:\n";
+        for (const std::string &token: this->skip_tokens) {
+            ss << token << '\n';
+        }
+    }
+
+    // add the mode every switching token enters
+    if (!this->mode_switches.empty()) {
+        ss << "\nSwitches:\n";
+        for (const auto &pair: this->mode_switches) {
+            ss << pair.first << ' ' << pair.second << '\n';
+        }
+    }
+
+    // add the automata of the other modes, each one after its own header
+    for (const auto &pair: this->modes) {
+        ss << "\nMode: " << pair.first << '\n' << pair.second->to_string();
+    }
+
     return ss.str();
 }
 
@@ -442,157 +582,218 @@ void Automaton::export_to_file(const std::string &filename) {
 std::shared_ptr<Automaton> Automaton::import_from_file(const std::string &filename) {
     std::ifstream file(filename);
     if (file.is_open()) {
+        // the automata of the other modes follow the main one, each after a "Mode: NAME" line
+        std::vector<std::pair<std::string, std::stringstream>> parts{};
+        parts.emplace_back("", std::stringstream());
         std::string line;
-        std::shared_ptr<Automaton> automaton = std::make_shared<Automaton>();
         while (std::getline(file, line)) {
-            // erase the space at the end of the line
-            line.erase(line.find_last_not_of(" \n\r\t") + 1);
-            // Parse the line and update the automaton object
-
-            // Check if the line contains the states
-            if (line.substr(0, 7) == "States:") {
-                // Remove the "States: " part from the line
-                line.erase(0, 8);
+            if (line.substr(0, 6) == "Mode: ") {
+                parts.emplace_back(line.substr(6), std::stringstream());
+            } else {
+                parts.back().second << line << '\n';
+            }
+        }
+        file.close();
+        std::shared_ptr<Automaton> automaton = import_from_stream(parts.front().second);
+        for (std::size_t i = 1; i < parts.size(); i++) {
+            automaton->add_mode(parts[i].first, import_from_stream(parts[i].second));
+        }
+        return automaton;
+    } else {
+        std::cout << "Unable to open file";
+        return nullptr;
+    }
+}
 
-                // Split the line into state IDs
-                std::istringstream iss(line);
-                std::vector<std::string> stateIDs((std::istream_iterator<std::string>(iss)),
-                                                  std::istream_iterator<std::string>());
-
-                // Add each state to the automaton
-                for (const auto &id: stateIDs) {
-                    try {
-                        automaton->add_state(std::make_shared<State>(std::stoi(id), false, ""));
-                    } catch (const std::invalid_argument &e) {
-                        std::cerr << "Invalid state ID: " << id << '\n';
-                    } catch (const std::out_of_range &e) {
-                        std::cerr << "State ID out of range: " << id << '\n';
-                    }
+std::shared_ptr<Automaton> Automaton::import_from_stream(std::istream &file) {
+    std::string line;
+    std::shared_ptr<Automaton> automaton = std::make_shared<Automaton>();
+    while (std::getline(file, line)) {
+        // erase the space at the end of the line
+        line.erase(line.find_last_not_of(" \n\r\t") + 1);
+        // Parse the line and update the automaton object
+
+        // Check if the line contains the states
+        if (line.substr(0, 7) == "States:") {
+            // Remove the "States: " part from the line
+            line.erase(0, 8);
+
+            // Split the line into state IDs
+            std::istringstream iss(line);
+            std::vector<std::string> stateIDs((std::istream_iterator<std::string>(iss)),
+                                              std::istream_iterator<std::string>());
+
+            // Add each state to the automaton
+            for (const auto &id: stateIDs) {
+                try {
+                    automaton->add_state(std::make_shared<State>(std::stoi(id), false, ""));
+                } catch (const std::invalid_argument &e) {
+                    std::cerr << "Invalid state ID: " << id << '\n';
+                } catch (const std::out_of_range &e) {
+                    std::cerr << "State ID out of range: " << id << '\n';
                 }
             }
+        }
 
-            if (line.substr(0, 14) == "Input Symbols:") {
-                // Remove the "Input Symbols: " part from the line
-                line.erase(0, 15);
+        if (line.substr(0, 14) == "Input Symbols:") {
+            // Remove the "Input Symbols: " part from the line
+            line.erase(0, 15);
 
-                // Split the line into symbols
-                std::istringstream iss(line);
-                std::vector<std::string> symbols((std::istream_iterator<std::string>(iss)),
-                                                 std::istream_iterator<std::string>());
+            // Split the line into symbols
+            std::istringstream iss(line);
+            std::vector<std::string> symbols((std::istream_iterator<std::string>(iss)),
+                                             std::istream_iterator<std::string>());
 
-                // Add each symbol to the automaton
-                for (const auto &symbol: symbols) {
-                    automaton->add_alphabet(symbol);
-                }
+            // Add each symbol to the automaton
+            for (const auto &symbol: symbols) {
+                automaton->add_alphabet(unescape_symbol(symbol));
             }
+        }
+
+        if (line.substr(0, 12) == "Start State:") {
+            // Remove the "Start State: " part from the line
+            line.erase(0, 13);
 
-            if (line.substr(0, 12) == "Start State:") {
-                // Remove the "Start State: " part from the line
-                line.erase(0, 13);
+            // Parse the start state ID
+            int startStateID = std::stoi(line);
 
-                // Parse the start state ID
-                int startStateID = std::stoi(line);
+            // Set the start state in the automaton
+            automaton->set_start(automaton->get_state_using_id(startStateID));
+        }
+
+        if (line.substr(0, 13) == "Final States:") {
+            // Remove the "Final States: " part from the line
+            line.erase(0, 14);
+
+            // Split the line into state IDs
+            std::istringstream iss(line);
+            std::vector<std::string> stateIDs((std::istream_iterator<std::string>(iss)),
+                                              std::istream_iterator<std::string>());
+
+            // Add each state to the automaton
+            for (const auto &id: stateIDs) {
+                try {
+                    automaton->add_accepting_state(automaton->get_state_using_id(std::stoi(id)));
+                } catch (const std::invalid_argument &e) {
+                    std::cerr << "Invalid state ID: " << id << '\n';
+                } catch (const std::out_of_range &e) {
+                    std::cerr << "State ID out of range: " << id << '\n';
+                }
+            }
+        }
 
-                // Set the start state in the automaton
-                automaton->set_start(automaton->get_state_using_id(startStateID));
+        if (line.substr(0, 20) == "Transition Function:") {
+            // ReadCFG the next lines until a line that doesn't match the format "f(fromState, symbol) = toState" is encountered
+            while (std::getline(file, line) && !line.empty()) {
+                // Trim the trailing spaces
+                line.erase(line.find_last_not_of(" \n\r\t") + 1);
+
+                // The line should be in the format "f(fromState, symbol) = toState"
+                // Use a regular expression to parse this format
+                std::regex re(R"(f\((\d+), (.+)\) = (\d+))");
+                std::smatch match;
+                if (std::regex_search(line, match, re) && match.size() > 3) {
+                    // Extract the fromState, symbol, and toState
+                    int fromStateID = std::stoi(match.str(1));
+                    std::string symbol = unescape_symbol(match.str(2));
+                    int toStateID = std::stoi(match.str(3));
+
+                    // Get the fromState and toState pointers
+                    std::shared_ptr<State> fromState = automaton->get_state_using_id(fromStateID);
+                    std::shared_ptr<State> toState = automaton->get_state_using_id(toStateID);
+
+                    // Add the transition to the automaton
+                    Types::state_set_t toStates = {toState};
+                    automaton->add_transitions(fromState, symbol, toStates);
+                } else {
+                    // If the line doesn't match the format "f(fromState, symbol) = toState", stop reading the transition function
+                    break;
+                }
             }
+        }
 
-            if (line.substr(0, 13) == "Final States:") {
-                // Remove the "Final States: " part from the line
-                line.erase(0, 14);
+        if (line.substr(0, 6) == "Regex:") {
+            // Remove the "Regex: " part from the line
+            line.erase(0, 7);
 
-                // Split the line into state IDs
-                std::istringstream iss(line);
-                std::vector<std::string> stateIDs((std::istream_iterator<std::string>(iss)),
-                                                  std::istream_iterator<std::string>());
-
-                // Add each state to the automaton
-                for (const auto &id: stateIDs) {
-                    try {
-                        automaton->add_accepting_state(automaton->get_state_using_id(std::stoi(id)));
-                    } catch (const std::invalid_argument &e) {
-                        std::cerr << "Invalid state ID: " << id << '\n';
-                    } catch (const std::out_of_range &e) {
-                        std::cerr << "State ID out of range: " << id << '\n';
-                    }
+            // Set the regex in the automaton
+            automaton->set_regex(line);
+        }
+
+        if (line.substr(0, 7) == "Tokens:") {
+            // ReadCFG the next lines until an empty line is encountered
+            while (std::getline(file, line) && !line.empty()) {
+                // The line should be in the format "[number]: token1 token2 ..."
+                // Use a regular expression to parse this format
+                std::regex re(R"(\[(\d+)\]: (.+))");
+                std::smatch match;
+                if (std::regex_search(line, match, re) && match.size() > 2) {
+                    // Extract the id and the tokens
+                    int id = std::stoi(match.str(1));
+                    std::string tokens_str = match.str(2);
+
+                    // Split the tokens_str into individual tokens
+                    std::istringstream iss(tokens_str);
+                    std::vector<std::string> vector_tokens((std::istream_iterator<std::string>(iss)),
+                                                           std::istream_iterator<std::string>());
+
+                    // Add each token to the automaton
+                    std::shared_ptr<State> state_ptr = automaton->get_state_using_id(id);
+                    state_ptr->setToken(*vector_tokens.begin());
+                    state_ptr->setAccepting(true);
+                    Types::string_set_t ts = {};
+                    ts.insert(vector_tokens.begin(), vector_tokens.end());
+                    automaton->add_tokens(state_ptr, ts);
                 }
             }
+        }
+
 
-            if (line.substr(0, 20) == "Transition Function:") {
-                // ReadCFG the next lines until a line that doesn't match the format "f(fromState, symbol) = toState" is encountered
-                while (std::getline(file, line) && !line.empty()) {
-                    // Trim the trailing spaces
-                    line.erase(line.find_last_not_of(" \n\r\t") + 1);
-
-                    // The line should be in the format "f(fromState, symbol) = toState"
-                    // Use a regular expression to parse this format
-                    std::regex re(R"(f\((\d+), (.+)\) = (\d+))");
-                    std::smatch match;
-                    if (std::regex_search(line, match, re) && match.size() > 3) {
-                        // Extract the fromState, symbol, and toState
-                        int fromStateID = std::stoi(match.str(1));
-                        std::string symbol = match.str(2);
-                        int toStateID = std::stoi(match.str(3));
-
-                        // Get the fromState and toState pointers
-                        std::shared_ptr<State> fromState = automaton->get_state_using_id(fromStateID);
-                        std::shared_ptr<State> toState = automaton->get_state_using_id(toStateID);
-
-                        // Add the transition to the automaton
-                        Types::state_set_t toStates = {toState};
-                        automaton->add_transitions(fromState, symbol, toStates);
-                    } else {
-                        // If the line doesn't match the format "f(fromState, symbol) = toState", stop reading the transition function
-                        break;
-                    }
+        if (line.substr(0, 8) == "Winners:") {
+            // ReadCFG the next lines until an empty line is encountered
+            while (std::getline(file, line) && !line.empty()) {
+                // The line should be in the format "[number]: token"
+                std::regex re(R"(\[(\d+)\]: (.+))");
+                std::smatch match;
+                if (std::regex_search(line, match, re) && match.size() > 2) {
+                    automaton->set_winning_token(automaton->get_state_using_id(std::stoi(match.str(1))),
+                                                 match.str(2));
                 }
             }
+        }
 
-            if (line.substr(0, 6) == "Regex:") {
-                // Remove the "Regex: " part from the line
-                line.erase(0, 7);
+        if (line.substr(0, 9) == "Keywords:") {
+            // ReadCFG the next lines until an empty line is encountered, one keyword per line
+            std::vector<std::string> keywords{};
+            while (std::getline(file, line) && !line.empty()) {
+                keywords.push_back(line);
+            }
+            automaton->set_hashed_keywords(keywords);
+        }
 
-                // Set the regex in the automaton
-                automaton->set_regex(line);
+        if (line.substr(0, 5) == "Skip:") {
+            // ReadCFG the next lines until an empty line is encountered, one token per line
+            std::vector<std::string> tokens{};
+            while (std::getline(file, line) && !line.empty()) {
+                tokens.push_back(line);
             }
+            automaton->set_skip_tokens(tokens);
+        }
 
-            if (line.substr(0, 7) == "Tokens:") {
-                // ReadCFG the next lines until an empty line is encountered
-                while (std::getline(file, line) && !line.empty()) {
-                    // The line should be in the format "[number]: token1 token2 ..."
-                    // Use a regular expression to parse this format
-                    std::regex re(R"(\[(\d+)\]: (.+))");
-                    std::smatch match;
-                    if (std::regex_search(line, match, re) && match.size() > 2) {
-                        // Extract the id and the tokens
-                        int id = std::stoi(match.str(1));
-                        std::string tokens_str = match.str(2);
-
-                        // Split the tokens_str into individual tokens
-                        std::istringstream iss(tokens_str);
-                        std::vector<std::string> vector_tokens((std::istream_iterator<std::string>(iss)),
-                                                               std::istream_iterator<std::string>());
-
-                        // Add each token to the automaton
-                        std::shared_ptr<State> state_ptr = automaton->get_state_using_id(id);
-                        state_ptr->setToken(*vector_tokens.begin());
-                        state_ptr->setAccepting(true);
-                        Types::string_set_t ts = {};
-                        ts.insert(vector_tokens.begin(), vector_tokens.end());
-                        automaton->add_tokens(state_ptr, ts);
-                    }
+        if (line.substr(0, 9) == "Switches:") {
+            // ReadCFG the next lines until an empty line is encountered, each one is "token MODE"
+            while (std::getline(file, line) && !line.empty()) {
+                std::istringstream iss(line);
+                std::string token, mode;
+                if (iss >> token >> mode) {
+                    automaton->set_mode_switch(token, mode);
                 }
             }
-
         }
-        file.close();
-//        automaton->give_new_ids_all();
-        return automaton;
 
-    } else {
-        std::cout << "Unable to open file";
-        return nullptr;
     }
+//    automaton->give_new_ids_all();
+    return automaton;
 }
 
 std::vector<std::vector<std::shared_ptr<State>>> Automaton::matrix_representation() {
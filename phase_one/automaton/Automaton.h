@@ -3,6 +3,7 @@
 
 
 #include "Types.h"
+#include <map>
 #include <vector>
 
 /**
@@ -38,6 +39,23 @@ private:
     // needed in the case where every state has more that on possible token, (final union of automata)
     Types::state_to_string_set_map_t tokens{};
 
+    // maps state (accepting) to the one token it reports, i.e. its token with the highest priority.
+    // resolved once when the final automaton is built, and exported with it.
+    Types::state_to_string_map_t winning_tokens{};
+
+    // keywords left out of the automaton because another token matches them too,
+    // the Predictor reclassifies the lexemes of that token with a perfect hash (see CompiledDFA).
+    std::vector<std::string> hashed_keywords{};
+
+    // tokens the Predictor recognises but never returns (whitespace, comments), declared with %skip.
+    std::vector<std::string> skip_tokens{};
+
+    // the automata of the other start conditions (modes), by mode name, this automaton is the INITIAL mode.
+    std::map<std::string, std::shared_ptr<Automaton>> modes{};
+
+    // the mode the Predictor enters after each of these tokens, declared with %switch.
+    std::map<std::string, std::string> mode_switches{};
+
     // The built-in epsilon symbol.
     const std::string BUILT_IN_EPSILON_SYMBOL = "\\L";
 
@@ -149,6 +167,44 @@ public:
 
     Types::state_to_string_set_map_t get_tokens();
 
+    // Picks, for every accepting state, the token with the highest priority among its tokens.
+    void resolve_winning_tokens(const std::map<std::string, int> &priorities);
+
+    // Returns the token an accepting state reports, or "" if it wasn't resolved.
+    std::string get_winning_token(const std::shared_ptr<State> &state_ptr);
+
+    void set_winning_token(const std::shared_ptr<State> &state_ptr, const std::string &token);
+
+    // Returns the keywords that aren't in the automaton but are recognised by a perfect hash.
+    const std::vector<std::string> &get_hashed_keywords();
+
+    void set_hashed_keywords(const std::vector<std::string> &keywords);
+
+    // The name of the mode of the rules without a <MODE> prefix, whose automaton is the main one.
+    static constexpr const char *INITIAL_MODE = "INITIAL";
+
+    // Returns the automata of the other modes, by mode name.
+    const std::map<std::string, std::shared_ptr<Automaton>> &get_modes();
+
+    void add_mode(const std::string &mode, const std::shared_ptr<Automaton> &automaton);
+
+    // Returns the mode entered after a token, by token name.
+    const std::map<std::string, std::string> &get_mode_switches();
+
+    void set_mode_switch(const std::string &token, const std::string &mode);
+
+    // Returns the tokens that are recognised and then discarded by the Predictor.
+    const std::vector<std::string> &get_skip_tokens();
+
+    void set_skip_tokens(const std::vector<std::string> &tokens);
+
+    // Returns a symbol as it is written in to_string(): whitespace becomes \s, \t, \n or \r so every line
+    // stays one line and symbols stay separated by spaces.
+    static std::string escape_symbol(const std::string &symbol);
+
+    // Reverses escape_symbol().
+    static std::string unescape_symbol(const std::string &symbol);
+
     std::string to_string_transition_table();
 
     std::string to_json();
@@ -157,6 +213,9 @@ public:
 
     static std::shared_ptr<Automaton> import_from_file(const std::string &filename);
 
+    // Reads one automaton in the format of to_string() (without the modes that follow it).
+    static std::shared_ptr<Automaton> import_from_stream(std::istream &file);
+
     std::vector<std::vector<std::shared_ptr<State>>> matrix_representation();
 
 };
@@ -82,6 +82,8 @@ public:
 
     using state_to_string_set_map_t = std::unordered_map<std::shared_ptr<State>, string_set_t, Types::map_hash, Types::map_equal>;
 
+    using state_to_string_map_t = std::unordered_map<std::shared_ptr<State>, std::string, Types::map_hash, Types::map_equal>;
+
     using state_set_t = std::unordered_set<std::shared_ptr<State>, Hash, Equal>;
 
     using transitions_t = std::unordered_map<key_t, state_set_t, pair_hash, pair_equal>;
@@ -45,10 +45,24 @@ std::map<std::string, int> LexicalRulesHandler::get_priorities() {
     return priorities_map;
 }
 
+void LexicalRulesHandler::set_keyword_hashing(bool enabled) {
+    this->keyword_hashing = enabled;
+}
+
 std::shared_ptr<Automaton> LexicalRulesHandler::export_automata(std::vector<std::shared_ptr<Automaton>> &automata,
                                                                 const std::string &output_file_path) {
-    std::shared_ptr<Automaton> nfa = Utilities::unionAutomataSet(automata);
-    std::shared_ptr<Automaton> dfa = conversions.convertToDFA(nfa, true);
+    // one DFA per mode, each one a union of the rules of its mode only
+    std::map<std::string, std::vector<std::shared_ptr<Automaton>>> by_mode{};
+    for (const std::shared_ptr<Automaton> &a: automata) {
+        auto it = this->token_modes.find(a->get_token());
+        by_mode[it == this->token_modes.end() ? Automaton::INITIAL_MODE : it->second].push_back(a);
+    }
+    std::shared_ptr<Automaton> dfa = this->build_dfa(by_mode[Automaton::INITIAL_MODE]);
+    for (const auto &pair: by_mode) {
+        if (pair.first != Automaton::INITIAL_MODE) {
+            dfa->add_mode(pair.first, this->build_dfa(pair.second));
+        }
+    }
     dfa->export_to_file(output_file_path);
     /*TODO: i don't know why yet, but you shouldn't minimize the dfa as it will lose details about the
      * tokens identification */
@@ -57,9 +71,49 @@ std::shared_ptr<Automaton> LexicalRulesHandler::export_automata(std::vector<std:
     return dfa;
 }
 
+std::shared_ptr<Automaton> LexicalRulesHandler::build_dfa(const std::vector<std::shared_ptr<Automaton>> &automata) {
+    std::vector<std::shared_ptr<Automaton>> kept{};
+    std::vector<std::string> hashed_keywords{};
+    for (const std::shared_ptr<Automaton> &a: automata) {
+        std::string token = a->get_token();
+        bool hashed = false;
+        // escaped keywords aren't their own lexeme, they stay in the automaton
+        if (this->keyword_hashing && token.find('\\') == std::string::npos &&
+            std::find(this->keywords.begin(), this->keywords.end(), token) != this->keywords.end()) {
+            for (const std::shared_ptr<Automaton> &other: automata) {
+                std::string other_token = other->get_token();
+                if (std::find(this->keywords.begin(), this->keywords.end(), other_token) == this->keywords.end() &&
+                    accepts(other, token)) {
+                    hashed = true;
+                    break;
+                }
+            }
+        }
+        if (hashed) {
+            hashed_keywords.push_back(token);
+        } else {
+            kept.push_back(a);
+        }
+    }
+    std::shared_ptr<Automaton> nfa = Utilities::unionAutomataSet(kept);
+    std::shared_ptr<Automaton> dfa = conversions.convertToDFA(nfa, true);
+    // resolve the priorities once here, so the Predictor only has to look up the token of a state
+    dfa->resolve_winning_tokens(this->get_priorities());
+    dfa->set_hashed_keywords(hashed_keywords);
+    dfa->set_skip_tokens(this->skip_tokens);
+    for (const auto &pair: this->mode_switches) {
+        dfa->set_mode_switch(pair.first, pair.second);
+    }
+    return dfa;
+}
+
 [[maybe_unused]] std::unordered_map<std::string, std::shared_ptr<Automaton>>
 LexicalRulesHandler::handleFile(const std::string &filename) {
     this->priorities = {};
+    this->keywords = {};
+    this->skip_tokens = {};
+    this->token_modes = {};
+    this->mode_switches = {};
     std::unordered_map<std::string, std::shared_ptr<Automaton>> automata{};
     std::vector<std::string> regex_tokens{};
     std::queue<std::pair<std::string, std::string>> backlog;
@@ -67,11 +121,35 @@ LexicalRulesHandler::handleFile(const std::string &filename) {
     std::string line{};
     while (std::getline(file, line)) {
         line = line.substr(line.find_first_not_of(" \n\r\t"), std::string::npos);
+        // "<MODE> rule" puts the tokens of the rule in a start condition other than INITIAL
+        std::string mode = Automaton::INITIAL_MODE;
+        std::size_t mode_end = line.find('>');
+        if (line.front() == '<' && mode_end != std::string::npos && mode_end > 1 &&
+            line.find_first_of(" \t", 1) > mode_end) {
+            mode = line.substr(1, mode_end - 1);
+            line = line.substr(mode_end + 1);
+            this->trim(line);
+        }
+        std::size_t previous_tokens = this->priorities.size();
         std::string non_terminal = line.substr(0, line.find_first_of(" \n\r\t"));
         bool is_regular_definition = non_terminal.back() == ':';
 
         std::string s = line.substr(1, line.length() - 2);
-        if (line.front() == '{') { // done
+        if (line.rfind("%switch", 0) == 0) {
+            // "%switch token MODE": after the token the Predictor goes on in MODE
+            std::istringstream ss(line.substr(7));
+            std::string token, target;
+            if (ss >> token >> target) {
+                this->mode_switches[token] = target;
+            }
+        } else if (line.rfind("%skip", 0) == 0) {
+            // These are the tokens to discard, e.g. "%skip ws comment"
+            std::istringstream ss(line.substr(5));
+            std::string token;
+            while (ss >> token) {
+                this->skip_tokens.push_back(token);
+            }
+        } else if (line.front() == '{') { // done
             // These are keywords
             std::istringstream ss(s);
             std::string keyword;
@@ -80,6 +158,7 @@ LexicalRulesHandler::handleFile(const std::string &filename) {
                 a->set_token(keyword);
                 automata[keyword] = a;
                 this->priorities.push_back(keyword);
+                this->keywords.push_back(keyword);
             }
         } else if (line.front() == '[') {
             // These are punctuation
@@ -125,6 +204,9 @@ LexicalRulesHandler::handleFile(const std::string &filename) {
             this->priorities.push_back(name);
             regex_tokens.push_back(name);
         }
+        for (std::size_t i = previous_tokens; i < this->priorities.size(); i++) {
+            this->token_modes[this->priorities[i]] = mode;
+        }
     }
     file.close();
 
@@ -166,6 +248,26 @@ void LexicalRulesHandler::handle_backlog(std::unordered_map<std::string, std::sh
     }
 }
 
+bool LexicalRulesHandler::accepts(const std::shared_ptr<Automaton> &a, const std::string &word) {
+    // the states were renumbered after their transitions were added, so the transitions are looked up by id here
+    std::map<std::pair<int, std::string>, int> next_state{};
+    for (const auto &entry: a->get_transitions()) {
+        if (!entry.second.empty()) {
+            next_state[{entry.first.first->getId(), entry.first.second}] = (*entry.second.begin())->getId();
+        }
+    }
+    int state = a->get_start()->getId();
+    for (char c: word) {
+        auto it = next_state.find({state, std::string(1, c)});
+        if (it == next_state.end()) {
+            return false;
+        }
+        state = it->second;
+    }
+    return std::any_of(a->get_accepting_states().begin(), a->get_accepting_states().end(),
+                       [state](const std::shared_ptr<State> &accepting) { return accepting->getId() == state; });
+}
+
 // trim from start (in place)
 void LexicalRulesHandler::ltrim(std::string &s) {
     s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](char &ch) {
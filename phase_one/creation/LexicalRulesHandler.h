@@ -21,6 +21,11 @@ public:
     // call this method only after you have called handleFile
     std::map<std::string, int> get_priorities();
 
+    // With keyword hashing on, export_automata() leaves out of the final automaton the keywords that another token
+    // (e.g. an identifier rule) matches too, the Predictor recognises them with a perfect hash instead.
+    // This keeps the identifier states from being split by every keyword prefix.
+    void set_keyword_hashing(bool enabled);
+
     // will make a union on the automata and then output them to the output file path
     std::shared_ptr<Automaton>
     export_automata(std::vector<std::shared_ptr<Automaton>> &automata, const std::string &output_file_path);
@@ -34,6 +39,15 @@ private:
     ToAutomaton toAutomaton;
     Conversions conversions;
     std::vector<std::string> priorities{};
+    // the keywords of the {} lines, in order
+    std::vector<std::string> keywords{};
+    // the tokens of the %skip lines, recognised and then discarded by the Predictor
+    std::vector<std::string> skip_tokens{};
+    // the mode (start condition) of every token of a "<MODE> rule" line, the others are in Automaton::INITIAL_MODE
+    std::unordered_map<std::string, std::string> token_modes{};
+    // the %switch lines, token -> the mode the Predictor enters after it
+    std::map<std::string, std::string> mode_switches{};
+    bool keyword_hashing = false;
     std::unordered_map<std::string, int> attempts{};
     const int MAX_ATTEMPTS = 100;
 
@@ -42,6 +56,12 @@ private:
                         std::queue<std::pair<std::string, std::string>> &backlog,
                         const std::vector<std::string> &regex_tokens);
 
+    // makes the final DFA of the rules of one mode.
+    std::shared_ptr<Automaton> build_dfa(const std::vector<std::shared_ptr<Automaton>> &automata);
+
+    // true if the (deterministic) automaton accepts the whole word.
+    static bool accepts(const std::shared_ptr<Automaton> &a, const std::string &word);
+
     // trim from start (in place)
     void ltrim(std::string &s);
 
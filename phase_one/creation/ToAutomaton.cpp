@@ -119,7 +119,9 @@ std::shared_ptr<Automaton> ToAutomaton::get_automaton_from_regular_definition(st
                     a = Utilities::get_epsilon_automaton(epsilonSymbol);
                 } else {
                     if (token.size() == 1){
-                        a = std::make_shared<Automaton>(token,temp + token,epsilonSymbol);
+                        // whitespace can't be written in a rule, it is escaped as \s \t \n or \r
+                        std::string symbol = Automaton::unescape_symbol(temp + token);
+                        a = std::make_shared<Automaton>(symbol.size() == 1 ? symbol : token, temp + token, epsilonSymbol);
                     } else {
                         a = get_automaton_from_map(token, map, epsilonSymbol);
                     }
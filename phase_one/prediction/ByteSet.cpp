@@ -0,0 +1,158 @@
+#include <cctype>
+#include "ByteSet.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <immintrin.h>
+
+#define COMPILER_PROJECT_HAS_X86_SIMD 1
+
+namespace {
+    enum class SimdLevel {
+        NONE, SSSE3, AVX2
+    };
+
+    SimdLevel simd_level() {
+        static const SimdLevel level = []() {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return SimdLevel::AVX2;
+            }
+            if (__builtin_cpu_supports("ssse3")) {
+                return SimdLevel::SSSE3;
+            }
+            return SimdLevel::NONE;
+        }();
+        return level;
+    }
+}
+#endif
+
+ByteSet ByteSet::whitespace() {
+    ByteSet set{};
+    for (int c = 0; c < 256; c++) {
+        if (std::isspace(c)) {
+            set.insert(static_cast<unsigned char>(c));
+        }
+    }
+    return set;
+}
+
+void ByteSet::insert(unsigned char c) {
+    this->members[c] = 1;
+    if (c < 0x80) {
+        this->low_nibble_masks[c & 0x0F] |= static_cast<std::uint8_t>(1u << (c >> 4));
+    } else {
+        this->high_low_nibble_masks[c & 0x0F] |= static_cast<std::uint8_t>(1u << ((c >> 4) - 8));
+    }
+}
+
+void ByteSet::insert_all(const ByteSet &other) {
+    for (int c = 0; c < 256; c++) {
+        if (other.members[c]) {
+            this->insert(static_cast<unsigned char>(c));
+        }
+    }
+}
+
+bool ByteSet::empty() const {
+    for (std::uint8_t member: this->members) {
+        if (member) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char *ByteSet::find_first_in(const char *begin, const char *end) const {
+    return this->find(begin, end, true);
+}
+
+const char *ByteSet::find_first_not_in(const char *begin, const char *end) const {
+    return this->find(begin, end, false);
+}
+
+const char *ByteSet::find(const char *begin, const char *end, bool wanted) const {
+#ifdef COMPILER_PROJECT_HAS_X86_SIMD
+    switch (simd_level()) {
+        case SimdLevel::AVX2:
+            return this->find_avx2(begin, end, wanted);
+        case SimdLevel::SSSE3:
+            return this->find_ssse3(begin, end, wanted);
+        case SimdLevel::NONE:
+            break;
+    }
+#endif
+    return this->find_scalar(begin, end, wanted);
+}
+
+const char *ByteSet::find_scalar(const char *begin, const char *end, bool wanted) const {
+    const unsigned char wanted_member = wanted ? 1 : 0;
+    for (const char *p = begin; p < end; p++) {
+        if (this->members[static_cast<unsigned char>(*p)] == wanted_member) {
+            return p;
+        }
+    }
+    return end;
+}
+
+#ifdef COMPILER_PROJECT_HAS_X86_SIMD
+
+__attribute__((target("ssse3")))
+const char *ByteSet::find_ssse3(const char *begin, const char *end, bool wanted) const {
+    const __m128i low_masks = _mm_load_si128(reinterpret_cast<const __m128i *>(this->low_nibble_masks.data()));
+    const __m128i high_masks = _mm_load_si128(reinterpret_cast<const __m128i *>(this->high_low_nibble_masks.data()));
+    const __m128i high_bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    const char *p = begin;
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        // pshufb yields 0 for lanes whose index has the top bit set, so each table only answers for its half
+        __m128i low = _mm_shuffle_epi8(low_masks, v);
+        __m128i high = _mm_shuffle_epi8(high_masks, _mm_xor_si128(v, flip));
+        __m128i bit = _mm_shuffle_epi8(high_bits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        __m128i absent = _mm_cmpeq_epi8(_mm_and_si128(_mm_or_si128(low, high), bit), zero);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(absent));
+        if (wanted) {
+            mask = ~mask & 0xFFFFu;
+        }
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return this->find_scalar(p, end, wanted);
+}
+
+__attribute__((target("avx2")))
+const char *ByteSet::find_avx2(const char *begin, const char *end, bool wanted) const {
+    // vpshufb shuffles each 128-bit lane on its own, so the tables are repeated in both lanes
+    const __m256i low_masks = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i *>(this->low_nibble_masks.data())));
+    const __m256i high_masks = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i *>(this->high_low_nibble_masks.data())));
+    const __m256i high_bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                               1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i flip = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    const char *p = begin;
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i low = _mm256_shuffle_epi8(low_masks, v);
+        __m256i high = _mm256_shuffle_epi8(high_masks, _mm256_xor_si256(v, flip));
+        __m256i bit = _mm256_shuffle_epi8(high_bits, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        __m256i absent = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_or_si256(low, high), bit), zero);
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(absent));
+        if (wanted) {
+            mask = ~mask;
+        }
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return this->find_ssse3(p, end, wanted);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef COMPILER_PROJECT_BYTESET_H
+#define COMPILER_PROJECT_BYTESET_H
+
+
+#include <array>
+#include <cstdint>
+
+/**
+ * This class is a set of byte values that can find the first byte of a range that is (or isn't) in the set
+ * 16 or 32 bytes at a time.
+ *
+ * On x86 the search uses SSSE3 or AVX2 (picked at run time from what the CPU supports) with the "truffle"
+ * technique of Hyperscan: two byte shuffles map the low nibble of every byte to the set of high nibbles
+ * it is paired with in the set, a third one turns the high nibble into a bit, and an AND tests membership
+ * for all 256 byte values exactly. Elsewhere a lookup table is scanned one byte at a time.
+ */
+class ByteSet {
+public:
+    ByteSet() = default;
+
+    // Returns the whitespace characters of std::isspace.
+    static ByteSet whitespace();
+
+    void insert(unsigned char c);
+
+    void insert_all(const ByteSet &other);
+
+    [[nodiscard]] bool contains(unsigned char c) const { return this->members[c] != 0; }
+
+    [[nodiscard]] bool empty() const;
+
+    // Returns the first byte of [begin, end) that is in the set, or end.
+    const char *find_first_in(const char *begin, const char *end) const;
+
+    // Returns the first byte of [begin, end) that isn't in the set, or end.
+    const char *find_first_not_in(const char *begin, const char *end) const;
+
+private:
+    // one entry per byte value, for the scalar path and the tails of the vector paths
+    std::array<std::uint8_t, 256> members{};
+    // truffle masks: bit h of low_nibble_masks[l] is set if the byte (h << 4 | l) is in the set,
+    // for the bytes below 0x80 (first array) and from 0x80 on (second array, h is the high nibble - 8)
+    alignas(16) std::array<std::uint8_t, 16> low_nibble_masks{};
+    alignas(16) std::array<std::uint8_t, 16> high_low_nibble_masks{};
+
+    // scans for the first byte whose membership is `wanted`
+    const char *find(const char *begin, const char *end, bool wanted) const;
+
+    const char *find_scalar(const char *begin, const char *end, bool wanted) const;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+    __attribute__((target("ssse3")))
+    const char *find_ssse3(const char *begin, const char *end, bool wanted) const;
+
+    __attribute__((target("avx2")))
+    const char *find_avx2(const char *begin, const char *end, bool wanted) const;
+
+#endif
+};
+
+
+#endif
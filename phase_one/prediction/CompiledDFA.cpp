@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include "CompiledDFA.h"
+
+CompiledDFA::CompiledDFA(std::shared_ptr<Automaton> &a, const TokenTable &token_table, std::size_t pair_table_budget,
+                         const std::vector<bool> &expected) {
+    // number the states, the start state first and the rest by id so the numbering is stable
+    std::vector<std::shared_ptr<State>> states(a->get_states().begin(), a->get_states().end());
+    std::sort(states.begin(), states.end(), [&a](const std::shared_ptr<State> &x, const std::shared_ptr<State> &y) {
+        bool x_start = *x == *a->get_start();
+        bool y_start = *y == *a->get_start();
+        if (x_start != y_start) {
+            return x_start;
+        }
+        return x->getId() < y->getId();
+    });
+    std::unordered_map<int, std::int32_t> index_of{};
+    for (std::size_t i = 0; i < states.size(); i++) {
+        index_of[states[i]->getId()] = static_cast<std::int32_t>(i);
+    }
+    auto state_count = static_cast<std::int32_t>(states.size());
+
+    this->skip_kinds.assign(token_table.size(), false);
+    for (const std::string &token: a->get_skip_tokens()) {
+        std::uint32_t kind = token_table.find(token);
+        if (kind != TokenTable::NO_TOKEN) {
+            this->skip_kinds[kind] = true;
+        }
+    }
+    // the tokens this DFA may report, the skipped ones are always scanned so they still separate tokens
+    auto allowed = [this, &expected](std::uint32_t kind) {
+        return expected.empty() || (kind < expected.size() && expected[kind]) || this->is_skip(kind);
+    };
+    // every token an accepting state matches, by state id, only needed to pick among the expected ones
+    std::unordered_map<int, Types::string_set_t> tokens_of{};
+    if (!expected.empty()) {
+        for (const auto &pair: a->get_tokens()) {
+            tokens_of[pair.first->getId()].insert(pair.second.begin(), pair.second.end());
+        }
+    }
+
+    // the token each accepting state reports
+    this->accepting.assign(states.size(), NOT_ACCEPTING);
+    for (std::int32_t i = 0; i < state_count; i++) {
+        const std::shared_ptr<State> &state_ptr = states[i];
+        if (!a->is_accepting_state(state_ptr)) {
+            continue;
+        }
+        if (!expected.empty()) {
+            // the highest priority token among the expected ones, the states of the others become dead below
+            Types::string_set_t candidates = tokens_of[state_ptr->getId()];
+            candidates.insert(state_ptr->getToken());
+            for (const std::string &t: candidates) {
+                std::uint32_t kind = token_table.find(t);
+                if (kind != TokenTable::NO_TOKEN && allowed(kind)) {
+                    this->accepting[i] = std::min(this->accepting[i], kind);
+                }
+            }
+            continue;
+        }
+        std::string winner = a->get_winning_token(state_ptr);
+        if (!winner.empty()) {
+            this->accepting[i] = token_table.id(winner);
+            continue;
+        }
+        // automata exported before the winners were resolved at build time: the smallest id has the highest priority
+        Types::string_set_t candidates = a->get_tokens(state_ptr);
+        if (candidates.empty()) {
+            candidates.insert(state_ptr->getToken());
+        }
+        for (const std::string &t: candidates) {
+            this->accepting[i] = std::min(this->accepting[i], token_table.find(t));
+        }
+    }
+
+    // the transitions of every byte of the alphabets, one column per byte
+    std::map<unsigned char, std::vector<std::int32_t>> columns{};
+    for (const std::string &symbol: a->get_alphabets()) {
+        if (symbol.size() != 1) {
+            continue;
+        }
+        std::vector<std::int32_t> column(states.size(), DEAD);
+        for (std::int32_t i = 0; i < state_count; i++) {
+            Types::state_set_t next_states = a->get_next_states(states[i], symbol);
+            if (!next_states.empty()) {
+                column[i] = index_of.at((*next_states.begin())->getId());
+            }
+        }
+        columns[static_cast<unsigned char>(symbol[0])] = column;
+    }
+
+    // states that can't reach an accepting state are dead, found by walking the transitions backwards
+    std::vector<std::vector<std::int32_t>> predecessors(states.size());
+    for (const auto &entry: columns) {
+        for (std::int32_t i = 0; i < state_count; i++) {
+            if (entry.second[i] != DEAD) {
+                predecessors[entry.second[i]].push_back(i);
+            }
+        }
+    }
+    std::vector<bool> alive(states.size(), false);
+    std::queue<std::int32_t> queue{};
+    for (std::int32_t i = 0; i < state_count; i++) {
+        if (this->accepting[i] != NOT_ACCEPTING) {
+            alive[i] = true;
+            queue.push(i);
+        }
+    }
+    while (!queue.empty()) {
+        std::int32_t state = queue.front();
+        queue.pop();
+        for (std::int32_t predecessor: predecessors[state]) {
+            if (!alive[predecessor]) {
+                alive[predecessor] = true;
+                queue.push(predecessor);
+            }
+        }
+    }
+    for (auto &entry: columns) {
+        for (std::int32_t &next_state: entry.second) {
+            if (next_state != DEAD && !alive[next_state]) {
+                next_state = DEAD;
+            }
+        }
+    }
+
+    // bytes with the same column share a class, class 0 is the all-DEAD column of the bytes outside the alphabets
+    std::map<std::vector<std::int32_t>, std::uint16_t> class_of{};
+    std::vector<const std::vector<std::int32_t> *> class_columns{};
+    class_columns.push_back(&class_of.emplace(std::vector<std::int32_t>(states.size(), DEAD), 0).first->first);
+    for (const auto &entry: columns) {
+        auto inserted = class_of.emplace(entry.second, static_cast<std::uint16_t>(class_columns.size()));
+        if (inserted.second) {
+            class_columns.push_back(&inserted.first->first);
+        }
+        this->byte_classes[entry.first] = inserted.first->second;
+        this->alphabet.insert(entry.first);
+    }
+    this->num_classes = class_columns.size();
+
+    ByteSet whitespace = ByteSet::whitespace();
+    for (int c = 0; c < 256; c++) {
+        if (whitespace.contains(static_cast<unsigned char>(c)) && !this->alphabet.contains(static_cast<unsigned char>(c))) {
+            this->separators.insert(static_cast<unsigned char>(c));
+        }
+    }
+    this->recognised = this->separators;
+    this->recognised.insert_all(this->alphabet);
+
+    this->transitions.assign(states.size() * this->num_classes, DEAD);
+    for (std::size_t c = 0; c < this->num_classes; c++) {
+        for (std::int32_t i = 0; i < state_count; i++) {
+            this->transitions[i * this->num_classes + c] = (*class_columns[c])[i];
+        }
+    }
+
+    // the self-loops, over the real bytes so the scan doesn't need the classes
+    this->loop_of.assign(states.size(), -1);
+    for (std::int32_t i = 0; i < state_count; i++) {
+        ByteSet loop{};
+        for (int c = 0; c < 256; c++) {
+            if (this->next(i, static_cast<unsigned char>(c)) == i) {
+                loop.insert(static_cast<unsigned char>(c));
+            }
+        }
+        if (!loop.empty()) {
+            this->loop_of[i] = static_cast<std::int32_t>(this->self_loops.size());
+            this->self_loops.push_back(loop);
+        }
+    }
+
+    // the keywords left to the perfect hash, each one is reclassified from the token the DFA accepts it as
+    std::vector<std::pair<std::string, std::uint32_t>> hashed{};
+    for (const std::string &keyword: a->get_hashed_keywords()) {
+        std::int32_t state = this->start_state();
+        for (std::size_t i = 0; i < keyword.size() && state != DEAD; i++) {
+            state = this->next(state, static_cast<unsigned char>(keyword[i]));
+        }
+        std::uint32_t id = token_table.id(keyword);
+        if (!allowed(id)) {
+            // an unexpected keyword stays what the DFA accepts it as
+            continue;
+        }
+        if (state == DEAD || this->accepting[state] == NOT_ACCEPTING || this->accepting[state] < id) {
+            // the keyword never wins against the token that matches it
+            continue;
+        }
+        hashed.emplace_back(keyword, id);
+        this->keyword_hosts.resize(token_table.size(), false);
+        this->keyword_hosts[this->accepting[state]] = true;
+    }
+    this->keywords = KeywordHash(hashed);
+
+    // the stride-2 table, if it fits
+    std::size_t pair_count = states.size() * this->num_classes * this->num_classes;
+    if (pair_count * sizeof(PairStep) > pair_table_budget) {
+        return;
+    }
+    this->pair_transitions.assign(pair_count, PairStep{DEAD, DEAD});
+    for (std::int32_t i = 0; i < state_count; i++) {
+        for (std::size_t c1 = 0; c1 < this->num_classes; c1++) {
+            std::int32_t middle = this->transitions[i * this->num_classes + c1];
+            // an accept in the middle may be the end of the token, the scanner has to stop there
+            if (middle == DEAD || this->accepting[middle] != NOT_ACCEPTING) {
+                continue;
+            }
+            for (std::size_t c2 = 0; c2 < this->num_classes; c2++) {
+                this->pair_transitions[(i * this->num_classes + c1) * this->num_classes + c2] =
+                        PairStep{middle, this->transitions[middle * this->num_classes + c2]};
+            }
+        }
+    }
+}
+
+CompiledModes CompiledDFA::compile_modes(std::shared_ptr<Automaton> &a, const TokenTable &token_table,
+                                         std::size_t pair_table_budget) {
+    std::vector<std::shared_ptr<Automaton>> automata{a};
+    for (const auto &pair: a->get_modes()) {
+        automata.push_back(pair.second);
+    }
+    std::vector<std::int32_t> switches = resolve_switches(a, token_table);
+    CompiledModes modes{};
+    for (std::shared_ptr<Automaton> &automaton: automata) {
+        auto dfa = std::make_shared<CompiledDFA>(automaton, token_table, pair_table_budget);
+        dfa->switches = switches;
+        modes.push_back(std::move(dfa));
+    }
+    return modes;
+}
+
+std::shared_ptr<const CompiledDFA>
+CompiledDFA::compile_expected(std::shared_ptr<Automaton> &a, std::size_t mode, const TokenTable &token_table,
+                              const std::vector<bool> &expected, std::size_t pair_table_budget) {
+    std::shared_ptr<Automaton> automaton = a;
+    if (mode > 0) {
+        if (mode > a->get_modes().size()) {
+            throw std::runtime_error("Unknown mode: " + std::to_string(mode));
+        }
+        automaton = std::next(a->get_modes().begin(), static_cast<std::ptrdiff_t>(mode - 1))->second;
+    }
+    auto dfa = std::make_shared<CompiledDFA>(automaton, token_table, pair_table_budget, expected);
+    dfa->switches = resolve_switches(a, token_table);
+    return dfa;
+}
+
+std::vector<std::int32_t> CompiledDFA::resolve_switches(std::shared_ptr<Automaton> &a, const TokenTable &token_table) {
+    // the modes in the order of compile_modes()
+    std::vector<std::string> names{Automaton::INITIAL_MODE};
+    for (const auto &pair: a->get_modes()) {
+        names.push_back(pair.first);
+    }
+    std::vector<std::int32_t> switches(token_table.size(), KEEP_MODE);
+    for (const auto &pair: a->get_mode_switches()) {
+        auto it = std::find(names.begin(), names.end(), pair.second);
+        if (it == names.end()) {
+            throw std::runtime_error("Unknown mode: " + pair.second);
+        }
+        switches[token_table.id(pair.first)] = static_cast<std::int32_t>(it - names.begin());
+    }
+    return switches;
+}
@@ -0,0 +1,159 @@
+#ifndef COMPILER_PROJECT_COMPILEDDFA_H
+#define COMPILER_PROJECT_COMPILEDDFA_H
+
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "ByteSet.h"
+#include "KeywordHash.h"
+#include "TokenTable.h"
+
+class CompiledDFA;
+
+// The compiled DFAs of all the modes of a lexer, indexed by mode (INITIAL first), see CompiledDFA::compile_modes().
+using CompiledModes = std::vector<std::shared_ptr<const CompiledDFA>>;
+
+/**
+ * This class is the final DFA in the form the Predictor runs it: dense arrays instead of maps of shared pointers.
+ *  - states are numbered 0..state_count()-1, start_state() is 0,
+ *  - bytes are compressed into classes of bytes that have the same transitions in every state,
+ *    class 0 is every byte outside the alphabets,
+ *  - transitions are a state_count() x class_count() table, DEAD marks a missing transition and every
+ *    transition into a state that can't reach an accepting state,
+ *  - every accepting state stores the id of the one token it reports (resolved by priority when the
+ *    final automaton was built, see Automaton::resolve_winning_tokens),
+ *  - states that loop on themselves (the body of an identifier or a number) are "accelerable": they keep
+ *    the set of bytes of the loop, so a run of them can be skipped with one ByteSet scan,
+ *  - optionally (when it fits the budget given to the constructor) a stride-2 table of
+ *    state_count() x class_count() x class_count() entries consumes two bytes per lookup.
+ *    A pair is only stored when the state between the two bytes is neither accepting nor dead,
+ *    so the scanner falls back to next() exactly where the longest match could end,
+ *  - the keywords left out of the automaton (see LexicalRulesHandler::set_keyword_hashing) are in a perfect hash,
+ *    reclassify() turns a lexeme of the token that now matches a keyword back into the keyword, if the keyword has
+ *    the higher priority. Since that token matches the keyword, leaving it out never changes where a token ends,
+ *  - the tokens declared with %skip (whitespace, comments) are flagged, the scanner drops them without returning,
+ *  - with start conditions there is one CompiledDFA per mode (see compile_modes()), and the tokens declared with
+ *    %switch know the mode the scanner goes on in after them,
+ *  - for parser-directed scanning a DFA can be specialized to the terminals the parser expects (see
+ *    compile_expected()): its accepting states report the best expected token they match and the states that only
+ *    lead to other tokens are dead, so e.g. a keyword where only an identifier is expected is scanned as one.
+ */
+class CompiledDFA {
+public:
+    static constexpr std::int32_t DEAD = -1;
+    static constexpr std::uint32_t NOT_ACCEPTING = UINT32_MAX;
+    // mode_switch() of a token that doesn't change the mode
+    static constexpr std::int32_t KEEP_MODE = -1;
+
+    // The two states a stride-2 step goes through, last is DEAD when the pair has to be taken one byte at a time.
+    struct PairStep {
+        std::int32_t middle;
+        std::int32_t last;
+    };
+
+    // pair_table_budget is the largest stride-2 table (in bytes) to build, 0 builds none.
+    // expected (indexed by kind) limits the tokens reported to the expected and the skipped ones, empty keeps all.
+    CompiledDFA(std::shared_ptr<Automaton> &a, const TokenTable &token_table, std::size_t pair_table_budget = 0,
+                const std::vector<bool> &expected = {});
+
+    /**
+     * Compiles the final automaton and the automata of its modes.
+     *
+     * @return one CompiledDFA per mode, the INITIAL mode (the automaton itself) first and the others by name,
+     * mode_switch() returns indices in this vector.
+     */
+    static CompiledModes compile_modes(std::shared_ptr<Automaton> &a, const TokenTable &token_table,
+                                       std::size_t pair_table_budget = 0);
+
+    // Compiles the DFA of a mode (an index of compile_modes()) specialized to the expected kinds.
+    static std::shared_ptr<const CompiledDFA>
+    compile_expected(std::shared_ptr<Automaton> &a, std::size_t mode, const TokenTable &token_table,
+                     const std::vector<bool> &expected, std::size_t pair_table_budget = 0);
+
+    [[nodiscard]] std::int32_t start_state() const { return 0; }
+
+    [[nodiscard]] std::int32_t next(std::int32_t state, unsigned char c) const {
+        return this->transitions[state * this->num_classes + this->byte_classes[c]];
+    }
+
+    // Returns the stride-2 step of state over the bytes c1 c2, only valid if has_pair_table().
+    [[nodiscard]] const PairStep &next_pair(std::int32_t state, unsigned char c1, unsigned char c2) const {
+        return this->pair_transitions[(state * this->num_classes + this->byte_classes[c1]) * this->num_classes +
+                                      this->byte_classes[c2]];
+    }
+
+    [[nodiscard]] bool has_pair_table() const { return !this->pair_transitions.empty(); }
+
+    // Returns the token id of an accepting state, or NOT_ACCEPTING.
+    [[nodiscard]] std::uint32_t accepting_kind(std::int32_t state) const {
+        return this->accepting[state];
+    }
+
+    // Returns the bytes on which the state goes back to itself, or nullptr if it has no self-loop.
+    [[nodiscard]] const ByteSet *self_loop(std::int32_t state) const {
+        std::int32_t loop = this->loop_of[state];
+        return loop < 0 ? nullptr : &this->self_loops[loop];
+    }
+
+    // Returns the kind of the token whose lexeme is `lexeme`, given that the DFA accepted it as `kind`.
+    [[nodiscard]] std::uint32_t reclassify(std::uint32_t kind, std::string_view lexeme) const {
+        if (kind >= this->keyword_hosts.size() || !this->keyword_hosts[kind]) {
+            return kind;
+        }
+        return this->keywords.find(lexeme, kind);
+    }
+
+    // Returns the mode the scanner enters after a token of this kind, or KEEP_MODE.
+    [[nodiscard]] std::int32_t mode_switch(std::uint32_t kind) const {
+        return kind < this->switches.size() ? this->switches[kind] : KEEP_MODE;
+    }
+
+    // true if tokens of this kind are discarded by the scanner.
+    [[nodiscard]] bool is_skip(std::uint32_t kind) const {
+        return kind < this->skip_kinds.size() && this->skip_kinds[kind];
+    }
+
+    [[nodiscard]] bool in_alphabet(unsigned char c) const { return this->byte_classes[c] != 0; }
+
+    // Returns the bytes of the alphabets (the bytes whose class isn't 0).
+    [[nodiscard]] const ByteSet &get_alphabet() const { return this->alphabet; }
+
+    // Returns the whitespace outside the alphabets, skipped between tokens.
+    [[nodiscard]] const ByteSet &get_separators() const { return this->separators; }
+
+    // Returns the bytes that are either separators or in the alphabets, every other byte is invalid input.
+    [[nodiscard]] const ByteSet &get_recognised() const { return this->recognised; }
+
+    [[nodiscard]] std::size_t state_count() const { return this->accepting.size(); }
+
+    [[nodiscard]] std::size_t class_count() const { return this->num_classes; }
+
+private:
+    // Returns the mode_switch() of every kind, from the switches and the modes of the final automaton.
+    static std::vector<std::int32_t> resolve_switches(std::shared_ptr<Automaton> &a, const TokenTable &token_table);
+
+    std::array<std::uint16_t, 256> byte_classes{};
+    ByteSet alphabet{};
+    ByteSet separators{};
+    ByteSet recognised{};
+    std::size_t num_classes{};
+    std::vector<std::int32_t> transitions{};
+    std::vector<PairStep> pair_transitions{};
+    std::vector<std::uint32_t> accepting{};
+    // index into self_loops of every state, -1 for the states that aren't accelerable
+    std::vector<std::int32_t> loop_of{};
+    std::vector<ByteSet> self_loops{};
+    KeywordHash keywords{};
+    // the kinds whose lexemes may be keywords, indexed by kind
+    std::vector<bool> keyword_hosts{};
+    std::vector<bool> skip_kinds{};
+    // the mode entered after each kind, filled by compile_modes()
+    std::vector<std::int32_t> switches{};
+};
+
+
+#endif
@@ -0,0 +1,91 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "Diagnostics.h"
+
+Diagnostics::Diagnostics(std::size_t cap) {
+    this->cap = cap;
+}
+
+void Diagnostics::invalid_input(std::uint64_t offset, char c) {
+    this->reported_count++;
+    if (!this->entries.empty()) {
+        Entry &last = this->entries.back();
+        if (last.kind == Kind::INVALID_INPUT && last.offset + last.length == offset) {
+            last.length++;
+            if (last.bytes.size() < MAX_SHOWN_BYTES) {
+                last.bytes.push_back(c);
+            }
+            return;
+        }
+    }
+    if (this->entries.size() >= this->cap) {
+        this->dropped_count++;
+        return;
+    }
+    this->entries.push_back({Kind::INVALID_INPUT, offset, 1, std::string(1, c)});
+}
+
+void Diagnostics::to_console() {
+    this->output = Output::CONSOLE;
+}
+
+void Diagnostics::to_file(const std::string &path) {
+    this->output = Output::FILE;
+    this->path = path;
+}
+
+void Diagnostics::to_nothing() {
+    this->output = Output::NONE;
+}
+
+void Diagnostics::flush(const std::function<SourcePosition(std::uint64_t)> &locate) {
+    if (this->empty()) {
+        return;
+    }
+    if (this->output != Output::NONE) {
+        // the colors are only for the console
+        bool console = this->output == Output::CONSOLE;
+        std::string red = console ? "\033[1;31m" : "";
+        std::string reset = console ? "\033[0m" : "";
+        // bytes that can't be printed (e.g. of a binary file) are written as \xNN
+        auto printable = [](const std::string &bytes) {
+            static constexpr char DIGITS[] = "0123456789abcdef";
+            std::string out{};
+            for (char c: bytes) {
+                auto byte = static_cast<unsigned char>(c);
+                if (byte >= 0x20 && byte < 0x7f) {
+                    out.push_back(c);
+                } else {
+                    out += {'\\', 'x', DIGITS[byte >> 4], DIGITS[byte & 0xf]};
+                }
+            }
+            return out;
+        };
+        std::ostringstream ss;
+        for (const Entry &entry: this->entries) {
+            ss << red << "Error: Invalid input" << reset << " at " << locate(entry.offset).to_string();
+            if (entry.length == 1) {
+                ss << ", ignoring character:'" << printable(entry.bytes) << "'\n";
+            } else {
+                ss << ", ignoring " << entry.length << " characters:'" << printable(entry.bytes)
+                   << (entry.length > entry.bytes.size() ? "...'" : "'") << '\n';
+            }
+        }
+        if (this->dropped_count != 0) {
+            ss << red << "Error:" << reset << " " << this->dropped_count << " more invalid inputs\n";
+        }
+        if (console) {
+            std::cout << ss.str() << std::flush;
+        } else {
+            std::ofstream file(this->path, std::ios::app);
+            if (!file) {
+                throw std::runtime_error("Failed to open file: " + this->path);
+            }
+            file << ss.str();
+        }
+    }
+    this->entries.clear();
+    this->dropped_count = 0;
+}
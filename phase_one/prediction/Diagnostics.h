@@ -0,0 +1,82 @@
+#ifndef COMPILER_PROJECT_DIAGNOSTICS_H
+#define COMPILER_PROJECT_DIAGNOSTICS_H
+
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "LineIndex.h"
+
+/**
+ * This class collects the errors of a scan and writes them all at once.
+ *
+ * Reporting an error only appends an entry to a vector, consecutive invalid bytes are coalesced into one entry,
+ * and past `cap` entries the errors are only counted. flush() formats the entries (locating them only then) and
+ * writes them with a single flush to where the caller chose: the console, a file (appended to) or nowhere.
+ */
+class Diagnostics {
+public:
+    // The entries kept by default, more errors are counted but not recorded.
+    static constexpr std::size_t DEFAULT_CAP = 1000;
+    // The bytes of an invalid run that are shown, the rest are only counted.
+    static constexpr std::size_t MAX_SHOWN_BYTES = 16;
+
+    enum class Kind : std::uint8_t {
+        INVALID_INPUT
+    };
+
+    enum class Output : std::uint8_t {
+        CONSOLE, FILE, NONE
+    };
+
+    // A run of `length` bytes from `offset`, the first ones of them in bytes.
+    struct Entry {
+        Kind kind;
+        std::uint64_t offset;
+        std::uint64_t length;
+        std::string bytes;
+    };
+
+    explicit Diagnostics(std::size_t cap = DEFAULT_CAP);
+
+    // Records a byte no token starts with, merged with the previous entry if it directly follows it.
+    void invalid_input(std::uint64_t offset, char c);
+
+    // Writes to std::cout (the default).
+    void to_console();
+
+    // Appends to a file.
+    void to_file(const std::string &path);
+
+    // Drops the errors.
+    void to_nothing();
+
+    /**
+     * Writes the entries to the chosen output and forgets them.
+     *
+     * @param locate gives the position of an offset, it is only called when there is something to write.
+     */
+    void flush(const std::function<SourcePosition(std::uint64_t)> &locate);
+
+    [[nodiscard]] const std::vector<Entry> &get_entries() const { return this->entries; }
+
+    // Returns the number of errors that didn't fit under the cap.
+    [[nodiscard]] std::size_t dropped() const { return this->dropped_count; }
+
+    [[nodiscard]] bool empty() const { return this->entries.empty() && this->dropped_count == 0; }
+
+    // Returns the number of invalid bytes reported since the Diagnostics was made, flushed or not.
+    [[nodiscard]] std::uint64_t reported() const { return this->reported_count; }
+
+private:
+    std::size_t cap{};
+    std::vector<Entry> entries{};
+    std::size_t dropped_count{};
+    std::uint64_t reported_count{};
+    Output output = Output::CONSOLE;
+    std::string path{};
+};
+
+
+#endif
@@ -0,0 +1,31 @@
+#include <algorithm>
+#include "FailedStates.h"
+
+FailedStates::FailedStates(std::size_t state_count) : state_count(state_count) {
+}
+
+void FailedStates::extend_trail(std::int32_t state, std::uint64_t first, std::uint64_t last) {
+    if (!this->trail.empty() && this->trail.back().state == state && this->trail.back().last + 1 == first) {
+        this->trail.back().last = last;
+    } else {
+        this->trail.push_back({state, first, last});
+    }
+}
+
+void FailedStates::remember(std::uint64_t token_start) {
+    if (this->trail.empty()) {
+        return;
+    }
+    if (this->failed_limit <= token_start) {
+        // everything remembered so far is behind the scanner
+        this->failed.clear();
+        this->failed_base = token_start;
+    }
+    for (const TrailRun &run: this->trail) {
+        for (std::uint64_t position = run.first; position <= run.last; position++) {
+            this->failed.insert((position - this->failed_base) * this->state_count + run.state);
+        }
+    }
+    this->failed_limit = std::max(this->failed_limit, this->trail.back().last + 1);
+    this->trail.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef COMPILER_PROJECT_FAILEDSTATES_H
+#define COMPILER_PROJECT_FAILEDSTATES_H
+
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * This class is the memo that keeps maximal munch linear.
+ * While a token is scanned, the (state, position) pairs entered since the last accepting state are kept on a
+ * trail. When the scan ends they are remembered as failed: no accepting state is reachable from them, so a
+ * later scan that enters one of them can stop right there instead of walking the same bytes again.
+ *
+ * Positions are absolute offsets of the program, "position" is the position after entering the state.
+ */
+class FailedStates {
+public:
+    FailedStates() = default;
+
+    explicit FailedStates(std::size_t state_count);
+
+    // true if entering state before the byte at position is known to never reach an accepting state.
+    [[nodiscard]] bool contains(std::int32_t state, std::uint64_t position) const {
+        return position < this->failed_limit &&
+               this->failed.count((position - this->failed_base) * this->state_count + state) != 0;
+    }
+
+    // Returns one past the largest remembered position, nothing from there on is failed.
+    [[nodiscard]] std::uint64_t limit() const { return this->failed_limit; }
+
+    // Forgets the trail, at the start of a scan and on every accepting state.
+    void clear_trail() { this->trail.clear(); }
+
+    // appends the positions first..last scanned in state to the trail, merging them with its last run.
+    void extend_trail(std::int32_t state, std::uint64_t first, std::uint64_t last);
+
+    // records the states of the trail as failed, token_start is where the scan that produced the trail began.
+    void remember(std::uint64_t token_start);
+
+private:
+    // the positions first..last (after entering the state) scanned without leaving state.
+    struct TrailRun {
+        std::int32_t state;
+        std::uint64_t first;
+        std::uint64_t last;
+    };
+
+    std::size_t state_count{};
+    // a run of a self-loop is a single entry.
+    std::vector<TrailRun> trail{};
+    // packed relative to failed_base.
+    std::unordered_set<std::uint64_t> failed{};
+    std::uint64_t failed_base{};
+    std::uint64_t failed_limit{};
+};
+
+
+#endif
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include "IncrementalLexer.h"
+#include "ScannerCursor.h"
+
+IncrementalLexer::IncrementalLexer(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities) {
+    this->tables = std::make_shared<const ScannerTables>(a, priorities);
+}
+
+const TokenTable &IncrementalLexer::get_token_table() const {
+    return this->tables->get_token_table();
+}
+
+LexedProgram IncrementalLexer::tokenize(std::string_view program) const {
+    LexedProgram result{};
+    this->lex_from(program, 0, 0, nullptr, nullptr, result);
+    return result;
+}
+
+LexedProgram IncrementalLexer::relex(const LexedProgram &old_program, std::string_view program,
+                                     const TextEdit &edit) const {
+    // keep the tokens that didn't look at the edited bytes (nor at the end of the program, for an edit there)
+    auto first_changed = static_cast<std::size_t>(
+            std::upper_bound(old_program.extents.begin(), old_program.extents.end(), edit.offset) -
+            old_program.extents.begin());
+    LexedProgram result{};
+    const TokenStream &old_tokens = old_program.tokens;
+    result.tokens.kinds.assign(old_tokens.kinds.begin(), old_tokens.kinds.begin() + first_changed);
+    result.tokens.offsets.assign(old_tokens.offsets.begin(), old_tokens.offsets.begin() + first_changed);
+    result.tokens.lengths.assign(old_tokens.lengths.begin(), old_tokens.lengths.begin() + first_changed);
+    result.starts.assign(old_program.starts.begin(), old_program.starts.begin() + first_changed);
+    result.extents.assign(old_program.extents.begin(), old_program.extents.begin() + first_changed);
+    result.modes.assign(old_program.modes.begin(), old_program.modes.begin() + first_changed);
+    bool has_call = first_changed < old_program.starts.size();
+    std::uint64_t start = has_call ? old_program.starts[first_changed] : old_program.end_start;
+    std::size_t mode = has_call ? old_program.modes[first_changed] : old_program.end_mode;
+    this->lex_from(program, start, mode, &old_program, &edit, result);
+    return result;
+}
+
+void IncrementalLexer::lex_from(std::string_view program, std::uint64_t start, std::size_t mode,
+                                const LexedProgram *old_program, const TextEdit *edit, LexedProgram &result) const {
+    ScannerCursor cursor(*this->tables, SourceBuffer::from_view(program));
+    cursor.seek(start);
+    cursor.set_mode(mode);
+    while (true) {
+        std::uint64_t position = cursor.position();
+        mode = cursor.mode();
+        if (old_program != nullptr && position >= edit->offset + edit->inserted.size()) {
+            // the same call in the old program would have started at old_position
+            std::uint64_t old_position = position - edit->inserted.size() + edit->removed;
+            auto synced = std::lower_bound(old_program->starts.begin(), old_program->starts.end(), old_position);
+            auto first = static_cast<std::size_t>(synced - old_program->starts.begin());
+            bool at_end = old_position == old_program->end_start && mode == old_program->end_mode;
+            bool at_call = synced != old_program->starts.end() && *synced == old_position &&
+                           old_program->modes[first] == mode;
+            if (at_end || at_call) {
+                // splice the rest of the old program, shifted by the edit
+                auto shift = [edit](std::uint64_t offset) { return offset + edit->inserted.size() - edit->removed; };
+                const TokenStream &old_tokens = old_program->tokens;
+                for (std::size_t i = first; i < old_program->starts.size(); i++) {
+                    result.tokens.kinds.push_back(old_tokens.kinds[i]);
+                    result.tokens.offsets.push_back(shift(old_tokens.offsets[i]));
+                    result.tokens.lengths.push_back(old_tokens.lengths[i]);
+                    result.starts.push_back(shift(old_program->starts[i]));
+                    result.extents.push_back(shift(old_program->extents[i]));
+                    result.modes.push_back(old_program->modes[i]);
+                }
+                result.end_start = shift(old_program->end_start);
+                result.end_extent = shift(old_program->end_extent);
+                result.end_mode = old_program->end_mode;
+                cursor.flush_diagnostics();
+                return;
+            }
+        }
+        Token token = cursor.next();
+        if (token.is_end()) {
+            result.end_start = position;
+            result.end_extent = cursor.examined_end();
+            result.end_mode = mode;
+            return;
+        }
+        result.tokens.kinds.push_back(token.kind);
+        result.tokens.offsets.push_back(token.offset);
+        result.tokens.lengths.push_back(token.length);
+        result.starts.push_back(position);
+        result.extents.push_back(cursor.examined_end());
+        result.modes.push_back(mode);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef COMPILER_PROJECT_INCREMENTALLEXER_H
+#define COMPILER_PROJECT_INCREMENTALLEXER_H
+
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "CompiledDFA.h"
+#include "ScannerTables.h"
+#include "Token.h"
+#include "TokenTable.h"
+
+/**
+ * An edit of a program: `removed` bytes at `offset` were replaced by `inserted`.
+ */
+struct TextEdit {
+    std::uint64_t offset;
+    std::uint64_t removed;
+    std::string inserted;
+};
+
+/**
+ * The tokens of a program together with what IncrementalLexer needs to re-lex it after an edit.
+ * For token i, starts[i] is where the call of Predictor::next() that returned it started scanning and
+ * extents[i] is one past the furthest byte that call depended on (Predictor::examined_end()) and modes[i] is the
+ * mode it scanned in.
+ * The last call, the one that found the end of the program, is end_start, end_extent and end_mode.
+ */
+struct LexedProgram {
+    TokenStream tokens{};
+    std::vector<std::uint64_t> starts{};
+    std::vector<std::uint64_t> extents{};
+    std::vector<std::size_t> modes{};
+    std::uint64_t end_start{};
+    std::uint64_t end_extent{};
+    std::size_t end_mode{};
+};
+
+/**
+ * This class keeps the tokens of a program up to date as it is edited, e.g. from an editor, without lexing
+ * the whole program after every keystroke.
+ *
+ * A call of next() only depends on the bytes from where it starts up to its extent, so the tokens whose extent
+ * ends before the edit are kept as they are. Lexing restarts at the first token that may have seen the edit and
+ * stops as soon as a call starts, past the edit, where (and in the mode) a call of the old program started (shifted by
+ * the edit):
+ * from there on the old tokens are the new ones, shifted. The cost is proportional to the edit and the tokens
+ * around it, not to the program.
+ *
+ * Invalid input is only reported for the part that is re-lexed.
+ */
+class IncrementalLexer {
+public:
+    IncrementalLexer(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities);
+
+    // Lexes a whole program.
+    LexedProgram tokenize(std::string_view program) const;
+
+    /**
+     * Re-lexes a program after an edit.
+     *
+     * @param old_program the result of tokenize() (or relex()) on the program before the edit.
+     * @param program the program after the edit.
+     * @param edit the edit, in the offsets of the program before it.
+     * @return the same as tokenize(program).
+     */
+    LexedProgram relex(const LexedProgram &old_program, std::string_view program, const TextEdit &edit) const;
+
+    // Returns the table that maps the kinds of the tokens to their names.
+    [[nodiscard]] const TokenTable &get_token_table() const;
+
+private:
+    // lexes from start (a position where a call of the old program started, in mode) until the calls re-sync with
+    // the old ones, appending to result.
+    void lex_from(std::string_view program, std::uint64_t start, std::size_t mode, const LexedProgram *old_program,
+                  const TextEdit *edit, LexedProgram &result) const;
+
+    std::shared_ptr<const ScannerTables> tables{};
+};
+
+
+#endif
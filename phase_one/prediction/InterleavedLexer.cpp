@@ -0,0 +1,131 @@
+#include <algorithm>
+#include "InterleavedLexer.h"
+
+InterleavedLexer::InterleavedLexer(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+                                   std::size_t lanes) {
+    this->token_table = TokenTable(priorities);
+    this->modes = CompiledDFA::compile_modes(a, this->token_table);
+    this->lanes = std::clamp<std::size_t>(lanes, 1, MAX_LANES);
+}
+
+Diagnostics &InterleavedLexer::get_diagnostics() {
+    return this->diagnostics;
+}
+
+const TokenTable &InterleavedLexer::get_token_table() const {
+    return this->token_table;
+}
+
+std::vector<TokenStream> InterleavedLexer::tokenize_all(const std::vector<std::string_view> &programs) {
+    std::vector<TokenStream> streams(programs.size());
+    std::vector<Lane> active{};
+    active.reserve(this->lanes);
+    std::size_t pending = 0;
+    auto start = [&](Lane &lane) {
+        lane = Lane{};
+        lane.program = programs[pending];
+        lane.out = &streams[pending];
+        lane.dfa = this->modes[0].get();
+        lane.diagnostics = this->diagnostics;
+        lane.failed = FailedStates(lane.dfa->state_count());
+        pending++;
+    };
+    while (pending < programs.size() && active.size() < this->lanes) {
+        active.emplace_back();
+        start(active.back());
+    }
+    while (!active.empty()) {
+        // one transition per lane per round, the lanes don't depend on each other
+        for (std::size_t i = 0; i < active.size();) {
+            if (this->step(active[i])) {
+                i++;
+            } else if (pending < programs.size()) {
+                start(active[i]);
+            } else {
+                active[i] = std::move(active.back());
+                active.pop_back();
+            }
+        }
+    }
+    return streams;
+}
+
+bool InterleavedLexer::step(Lane &lane) const {
+    if (!lane.in_token) {
+        // skip the separators before the token a vector at a time
+        const char *begin = lane.program.data() + lane.index;
+        const char *end = lane.program.data() + lane.program.size();
+        lane.index += lane.dfa->get_separators().find_first_not_in(begin, end) - begin;
+        if (lane.index == lane.program.size()) {
+            if (!lane.diagnostics.empty()) {
+                LineIndex lines(lane.program);
+                lane.diagnostics.flush([&lines](std::uint64_t offset) { return lines.locate(offset); });
+            }
+            return false;
+        }
+        lane.in_token = true;
+        lane.token_start = lane.index;
+        lane.state = lane.dfa->start_state();
+        lane.accepted_kind = Token::END_OF_INPUT;
+        lane.accepted_end = lane.index;
+        lane.failed.clear_trail();
+        return true;
+    }
+    if (lane.index == lane.program.size() || lane.failed.contains(lane.state, lane.index)) {
+        this->finish_token(lane);
+        return true;
+    }
+    std::int32_t next_state = lane.dfa->next(lane.state, static_cast<unsigned char>(lane.program[lane.index]));
+    if (next_state == CompiledDFA::DEAD) {
+        this->finish_token(lane);
+        return true;
+    }
+    lane.state = next_state;
+    lane.index++;
+    std::uint32_t kind = lane.dfa->accepting_kind(next_state);
+    if (kind != CompiledDFA::NOT_ACCEPTING) {
+        lane.accepted_kind = kind;
+        lane.accepted_end = lane.index;
+        lane.failed.clear_trail();
+    } else {
+        lane.failed.extend_trail(next_state, lane.index, lane.index);
+    }
+    return true;
+}
+
+void InterleavedLexer::finish_token(Lane &lane) const {
+    lane.in_token = false;
+    lane.failed.remember(lane.token_start);
+    if (lane.accepted_kind != Token::END_OF_INPUT) {
+        // rewind once, to the end of the longest match
+        std::string_view lexeme = lane.program.substr(lane.token_start, lane.accepted_end - lane.token_start);
+        std::uint32_t kind = lane.dfa->reclassify(lane.accepted_kind, lexeme);
+        lane.index = lane.accepted_end;
+        bool skip = lane.dfa->is_skip(kind);
+        std::int32_t target = lane.dfa->mode_switch(kind);
+        if (target != CompiledDFA::KEEP_MODE && this->modes[target].get() != lane.dfa) {
+            lane.dfa = this->modes[target].get();
+            lane.failed = FailedStates(lane.dfa->state_count());
+        }
+        if (skip) {
+            return;
+        }
+        lane.out->kinds.push_back(kind);
+        lane.out->offsets.push_back(lane.token_start);
+        lane.out->lengths.push_back(static_cast<std::uint32_t>(lane.accepted_end - lane.token_start));
+        return;
+    }
+
+    // no token starts here
+    lane.index = lane.token_start;
+    const char *begin = lane.program.data() + lane.index;
+    const char *end = begin + 1;
+    if (!lane.dfa->in_alphabet(static_cast<unsigned char>(*begin))) {
+        // skip the whole run of bytes outside the alphabets
+        end = lane.dfa->get_recognised().find_first_in(begin, lane.program.data() + lane.program.size());
+    }
+    for (const char *p = begin; p < end; p++) {
+        lane.diagnostics.invalid_input(lane.index + (p - begin), *p);
+    }
+    lane.index += end - begin;
+}
@@ -0,0 +1,84 @@
+#ifndef COMPILER_PROJECT_INTERLEAVEDLEXER_H
+#define COMPILER_PROJECT_INTERLEAVEDLEXER_H
+
+
+#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "CompiledDFA.h"
+#include "Diagnostics.h"
+#include "FailedStates.h"
+#include "Token.h"
+#include "TokenTable.h"
+
+/**
+ * This class lexes many independent programs through one CompiledDFA at the same time.
+ *
+ * A single Predictor spends most of its time waiting on a chain of dependent transition loads (the next state
+ * is needed to find the next one). Here up to `lanes` programs are scanned in lockstep: every round does one
+ * transition in each lane, so the loads of different lanes are independent and overlap in the memory system.
+ * When a lane finishes its program it picks up the next pending one.
+ *
+ * Every lane follows the same rules as Predictor::next() (longest match, a single rewind, the failed-state memo),
+ * and switches modes the same way, so the tokens of each program are exactly the ones Predictor::tokenize_all()
+ * returns for it.
+ */
+class InterleavedLexer {
+public:
+    static constexpr std::size_t DEFAULT_LANES = 8;
+    static constexpr std::size_t MAX_LANES = 16;
+
+    // lanes is clamped to 1..MAX_LANES.
+    InterleavedLexer(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+                     std::size_t lanes = DEFAULT_LANES);
+
+    /**
+     * Lexes every program, the programs must stay alive for the whole call.
+     *
+     * @return one TokenStream per program, in the order of programs.
+     */
+    std::vector<TokenStream> tokenize_all(const std::vector<std::string_view> &programs);
+
+    // Returns where the errors go, each program writes its own once it is lexed.
+    Diagnostics &get_diagnostics();
+
+    // Returns the table that maps the kinds of the tokens to their names.
+    [[nodiscard]] const TokenTable &get_token_table() const;
+
+private:
+    // the scan of one program
+    struct Lane {
+        std::string_view program{};
+        TokenStream *out{};
+        // the DFA of the mode the lane scans in
+        const CompiledDFA *dfa{};
+        std::uint64_t index{};
+        // between two tokens (separators are skipped next) or inside the scan of a token
+        bool in_token{};
+        std::uint64_t token_start{};
+        std::int32_t state{};
+        std::uint32_t accepted_kind{};
+        std::uint64_t accepted_end{};
+        FailedStates failed{};
+        // written once the program is consumed
+        Diagnostics diagnostics{};
+    };
+
+    // Moves the lane forward by one transition (or one token boundary).
+    // Returns false once the program of the lane is consumed.
+    bool step(Lane &lane) const;
+
+    // Ends the scan of the current token: emits the longest match or skips the input that starts no token.
+    void finish_token(Lane &lane) const;
+
+    TokenTable token_table{};
+    CompiledModes modes{};
+    std::size_t lanes{};
+    // the output of the Diagnostics of the lanes
+    Diagnostics diagnostics{};
+};
+
+
+#endif
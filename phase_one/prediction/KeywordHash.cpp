@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <stdexcept>
+#include "KeywordHash.h"
+
+KeywordHash::KeywordHash(const std::vector<std::pair<std::string, std::uint32_t>> &keywords) {
+    std::size_t n = keywords.size();
+    if (n == 0) {
+        return;
+    }
+    std::vector<std::vector<std::size_t>> buckets(n);
+    for (std::size_t i = 0; i < n; i++) {
+        buckets[hash(0, keywords[i].first) % n].push_back(i);
+    }
+    std::vector<std::size_t> order(n);
+    for (std::size_t b = 0; b < n; b++) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t x, std::size_t y) {
+        return buckets[x].size() > buckets[y].size();
+    });
+
+    this->seeds.assign(n, 0);
+    this->keys.assign(n, "");
+    this->ids.assign(n, 0);
+    std::vector<bool> taken(n, false);
+    std::vector<std::size_t> slots{};
+    for (std::size_t b: order) {
+        if (buckets[b].empty()) {
+            break;
+        }
+        for (std::uint32_t seed = 1;; seed++) {
+            if (seed == 0) {
+                throw std::runtime_error("Failed to build the keyword hash, are there duplicate keywords?");
+            }
+            slots.clear();
+            for (std::size_t i: buckets[b]) {
+                std::size_t slot = hash(seed, keywords[i].first) % n;
+                if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (slots.size() == buckets[b].size()) {
+                this->seeds[b] = seed;
+                for (std::size_t k = 0; k < slots.size(); k++) {
+                    taken[slots[k]] = true;
+                    this->keys[slots[k]] = keywords[buckets[b][k]].first;
+                    this->ids[slots[k]] = keywords[buckets[b][k]].second;
+                }
+                break;
+            }
+        }
+    }
+}
+
+std::uint32_t KeywordHash::find(std::string_view lexeme, std::uint32_t not_found) const {
+    if (this->keys.empty()) {
+        return not_found;
+    }
+    std::size_t n = this->keys.size();
+    std::size_t slot = hash(this->seeds[hash(0, lexeme) % n], lexeme) % n;
+    return this->keys[slot] == lexeme ? this->ids[slot] : not_found;
+}
+
+std::uint32_t KeywordHash::hash(std::uint32_t seed, std::string_view s) {
+    // FNV-1a with the seed mixed into the offset basis, and a final avalanche so the low bits are usable
+    std::uint32_t h = 2166136261u ^ (seed * 0x9E3779B1u);
+    for (char c: s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
@@ -0,0 +1,40 @@
+#ifndef COMPILER_PROJECT_KEYWORDHASH_H
+#define COMPILER_PROJECT_KEYWORDHASH_H
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * This class is a minimal perfect hash from keywords to their token ids, built once with the CompiledDFA.
+ *
+ * It uses "hash and displace": a first hash puts every keyword in a bucket, then, biggest buckets first, every
+ * bucket gets the first seed of a second hash that sends all its keywords to free slots. There are as many
+ * slots as keywords, so a lookup is two hashes, one slot and one string compare.
+ */
+class KeywordHash {
+public:
+    KeywordHash() = default;
+
+    explicit KeywordHash(const std::vector<std::pair<std::string, std::uint32_t>> &keywords);
+
+    // Returns the token id of the keyword, or not_found if the lexeme isn't one of the keywords.
+    [[nodiscard]] std::uint32_t find(std::string_view lexeme, std::uint32_t not_found) const;
+
+    [[nodiscard]] bool empty() const { return this->keys.empty(); }
+
+private:
+    static std::uint32_t hash(std::uint32_t seed, std::string_view s);
+
+    // the seed of the second hash of every bucket
+    std::vector<std::uint32_t> seeds{};
+    // the keyword and its token id in every slot
+    std::vector<std::string> keys{};
+    std::vector<std::uint32_t> ids{};
+};
+
+
+#endif
@@ -0,0 +1,31 @@
+#include <algorithm>
+#include <cstring>
+#include "LineIndex.h"
+
+std::string SourcePosition::to_string() const {
+    return "line " + std::to_string(this->line) + ", column " + std::to_string(this->column);
+}
+
+LineIndex::LineIndex(std::string_view program) {
+    this->add(program, 0);
+}
+
+void LineIndex::add(std::string_view bytes, std::uint64_t base) {
+    const char *begin = bytes.data();
+    const char *end = begin + bytes.size();
+    for (const char *p = begin; p < end; p++) {
+        p = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (p == nullptr) {
+            break;
+        }
+        this->newlines.push_back(base + (p - begin));
+    }
+    this->indexed_end = base + bytes.size();
+}
+
+SourcePosition LineIndex::locate(std::uint64_t offset) const {
+    // the newlines before the offset end the lines before its own
+    auto before = std::lower_bound(this->newlines.begin(), this->newlines.end(), offset);
+    std::uint64_t line_start = before == this->newlines.begin() ? 0 : *(before - 1) + 1;
+    return {static_cast<std::uint64_t>(before - this->newlines.begin()) + 1, offset - line_start + 1};
+}
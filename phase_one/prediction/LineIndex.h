@@ -0,0 +1,50 @@
+#ifndef COMPILER_PROJECT_LINEINDEX_H
+#define COMPILER_PROJECT_LINEINDEX_H
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A line and a column of the program, both counted from 1. The column is in bytes.
+ */
+struct SourcePosition {
+    std::uint64_t line;
+    std::uint64_t column;
+
+    // Returns "line L, column C".
+    [[nodiscard]] std::string to_string() const;
+};
+
+/**
+ * This class maps byte offsets of a program to lines and columns.
+ *
+ * The scanner never counts lines: the offsets of the newlines are collected by a separate memchr scan (vectorized
+ * by the C library) and a position is found by a binary search over them, only when a diagnostic needs it.
+ */
+class LineIndex {
+public:
+    LineIndex() = default;
+
+    // Indexes a whole program.
+    explicit LineIndex(std::string_view program);
+
+    // Indexes the bytes of the program that start at the absolute offset base, right after the bytes added before.
+    void add(std::string_view bytes, std::uint64_t base);
+
+    // Returns one past the last byte indexed.
+    [[nodiscard]] std::uint64_t end() const { return this->indexed_end; }
+
+    // Returns the line and column of the byte at an offset (an offset past the end is on the last line).
+    [[nodiscard]] SourcePosition locate(std::uint64_t offset) const;
+
+private:
+    // the offset of every newline, in order
+    std::vector<std::uint64_t> newlines{};
+    std::uint64_t indexed_end{};
+};
+
+
+#endif
@@ -0,0 +1,88 @@
+#include <cstdlib>
+#include <string>
+#include "NumberDecoder.h"
+
+bool NumberDecoder::decode(std::string_view lexeme, NumericValue &value) {
+    static constexpr double POWERS_OF_TEN[MAX_EXACT_POWER + 1] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    std::size_t i = 0;
+    std::size_t n = lexeme.size();
+    std::uint64_t mantissa = 0;
+    // digits that didn't fit in the mantissa, they only make it go through strtod
+    bool truncated = false;
+    std::size_t digits = 0;
+    auto accumulate = [&](char c) {
+        auto digit = static_cast<std::uint64_t>(c - '0');
+        if (mantissa > (UINT64_MAX - digit) / 10) {
+            truncated = true;
+        } else {
+            mantissa = mantissa * 10 + digit;
+        }
+        digits++;
+    };
+    while (i < n && lexeme[i] >= '0' && lexeme[i] <= '9') {
+        accumulate(lexeme[i++]);
+    }
+    if (digits == 0) {
+        return false;
+    }
+    std::int64_t exponent = 0;
+    bool real = false;
+    if (i < n && lexeme[i] == '.') {
+        real = true;
+        std::size_t fraction_start = ++i;
+        while (i < n && lexeme[i] >= '0' && lexeme[i] <= '9') {
+            accumulate(lexeme[i++]);
+        }
+        if (i == fraction_start) {
+            return false;
+        }
+        exponent -= static_cast<std::int64_t>(i - fraction_start);
+    }
+    if (i < n && (lexeme[i] == 'E' || lexeme[i] == 'e')) {
+        real = true;
+        i++;
+        bool negative = i < n && lexeme[i] == '-';
+        if (i < n && (lexeme[i] == '-' || lexeme[i] == '+')) {
+            i++;
+        }
+        std::size_t exponent_start = i;
+        std::int64_t written = 0;
+        while (i < n && lexeme[i] >= '0' && lexeme[i] <= '9') {
+            // past this the value is 0 or infinity anyway, strtod decides which
+            if (written < 100000) {
+                written = written * 10 + (lexeme[i] - '0');
+            }
+            i++;
+        }
+        if (i == exponent_start) {
+            return false;
+        }
+        exponent += negative ? -written : written;
+    }
+    if (i != n) {
+        return false;
+    }
+
+    if (!real && !truncated && mantissa <= static_cast<std::uint64_t>(INT64_MAX)) {
+        value.type = NumericValue::INTEGER;
+        value.integer = static_cast<std::int64_t>(mantissa);
+        return true;
+    }
+    value.type = NumericValue::REAL;
+    if (!truncated && mantissa <= (std::uint64_t{1} << 53) && exponent >= -MAX_EXACT_POWER &&
+        exponent <= MAX_EXACT_POWER) {
+        auto m = static_cast<double>(mantissa);
+        value.real = exponent < 0 ? m / POWERS_OF_TEN[-exponent] : m * POWERS_OF_TEN[exponent];
+    } else {
+        value.real = slow_path(lexeme);
+    }
+    return true;
+}
+
+double NumberDecoder::slow_path(std::string_view lexeme) {
+    // strtod needs a terminated string, the lexeme is a view into the program
+    std::string terminated(lexeme);
+    return std::strtod(terminated.c_str(), nullptr);
+}
@@ -0,0 +1,35 @@
+#ifndef COMPILER_PROJECT_NUMBERDECODER_H
+#define COMPILER_PROJECT_NUMBERDECODER_H
+
+
+#include <string_view>
+#include "Token.h"
+
+/**
+ * This class turns the lexemes of numeric tokens (digit+ | digit+ . digit+ (\L | E digit+)) into their values.
+ *
+ * A single pass over the bytes accumulates the digits of the integer and fraction parts into one 64-bit
+ * mantissa and reads the exponent:
+ *  - a lexeme without fraction and exponent that fits in 64 bits is an INTEGER,
+ *  - everything else is a REAL. When the mantissa has at most 53 bits and the power of ten is at most 22
+ *    (Clinger's fast path) both are exact doubles, so one multiplication or division gives the correctly rounded
+ *    value. The rare literals outside of it (very long or with big exponents) go through std::strtod.
+ */
+class NumberDecoder {
+public:
+    /**
+     * Decodes a numeric lexeme, an 'e' and a sign after the E are accepted too.
+     *
+     * @return false (and value untouched) if the lexeme isn't a number.
+     */
+    static bool decode(std::string_view lexeme, NumericValue &value);
+
+private:
+    // the largest power of ten that is an exact double
+    static constexpr int MAX_EXACT_POWER = 22;
+
+    static double slow_path(std::string_view lexeme);
+};
+
+
+#endif
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <thread>
+#include "ParallelLexer.h"
+
+ParallelLexer::ParallelLexer(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+                             std::size_t threads) {
+    this->tables = std::make_shared<const ScannerTables>(a, priorities);
+    this->threads = threads != 0 ? threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+const TokenTable &ParallelLexer::get_token_table() const {
+    return this->tables->get_token_table();
+}
+
+Diagnostics &ParallelLexer::get_diagnostics() {
+    return this->diagnostics;
+}
+
+void ParallelLexer::intern(const std::string &token_name, std::shared_ptr<SymbolTable> table) {
+    this->symbol_table = std::move(table);
+    this->interned_tokens.push_back(token_name);
+}
+
+void ParallelLexer::decode_numbers(const std::string &token_name) {
+    this->numeric_tokens.push_back(token_name);
+}
+
+ScannerCursor ParallelLexer::make_cursor(std::string_view program) const {
+    ScannerCursor cursor(*this->tables, SourceBuffer::from_view(program));
+    for (const std::string &token_name: this->interned_tokens) {
+        cursor.intern(token_name, this->symbol_table);
+    }
+    for (const std::string &token_name: this->numeric_tokens) {
+        cursor.decode_numbers(token_name);
+    }
+    return cursor;
+}
+
+void ParallelLexer::lex_chunk(std::string_view program, Chunk &chunk) const {
+    ScannerCursor cursor = this->make_cursor(program);
+    cursor.set_invalid_input_handler([&chunk](std::uint64_t offset, char c) {
+        chunk.invalid.emplace_back(offset, c);
+    });
+    cursor.seek(chunk.begin);
+    while (cursor.position() < chunk.end) {
+        chunk.call_starts.push_back(cursor.position());
+        chunk.call_modes.push_back(cursor.mode());
+        chunk.call_invalid.push_back(chunk.invalid.size());
+        Token token = cursor.next();
+        if (token.is_end()) {
+            break;
+        }
+        chunk.tokens.kinds.push_back(token.kind);
+        chunk.tokens.offsets.push_back(token.offset);
+        chunk.tokens.lengths.push_back(token.length);
+        chunk.tokens.symbols.push_back(token.symbol);
+        chunk.tokens.values.push_back(token.value);
+    }
+    chunk.stop = cursor.position();
+    chunk.stop_mode = cursor.mode();
+}
+
+TokenStream ParallelLexer::tokenize_all(std::string_view program) {
+    std::size_t count = std::clamp<std::size_t>(program.size() / MIN_CHUNK_SIZE, 1, this->threads);
+    std::vector<Chunk> chunks(count);
+    for (std::size_t i = 0; i < count; i++) {
+        chunks[i].begin = program.size() * i / count;
+        chunks[i].end = program.size() * (i + 1) / count;
+    }
+    std::vector<std::thread> workers{};
+    for (std::size_t i = 1; i < count; i++) {
+        workers.emplace_back([this, program, &chunks, i]() { this->lex_chunk(program, chunks[i]); });
+    }
+    this->lex_chunk(program, chunks[0]);
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+
+    // stitch the chunks in order, `position` and `mode` are where the sequential scanner makes its next call
+    TokenStream stream{};
+    std::vector<std::pair<std::uint64_t, char>> invalid{};
+    auto append = [&stream, &invalid](const Chunk &chunk, std::size_t first_call) {
+        stream.kinds.insert(stream.kinds.end(), chunk.tokens.kinds.begin() + first_call, chunk.tokens.kinds.end());
+        stream.offsets.insert(stream.offsets.end(), chunk.tokens.offsets.begin() + first_call, chunk.tokens.offsets.end());
+        stream.lengths.insert(stream.lengths.end(), chunk.tokens.lengths.begin() + first_call, chunk.tokens.lengths.end());
+        stream.symbols.insert(stream.symbols.end(), chunk.tokens.symbols.begin() + first_call, chunk.tokens.symbols.end());
+        stream.values.insert(stream.values.end(), chunk.tokens.values.begin() + first_call, chunk.tokens.values.end());
+        invalid.insert(invalid.end(), chunk.invalid.begin() + chunk.call_invalid[first_call], chunk.invalid.end());
+    };
+    std::uint64_t position = 0;
+    std::size_t mode = 0;
+    ScannerCursor relexer = this->make_cursor(program);
+    relexer.set_invalid_input_handler([&invalid](std::uint64_t offset, char c) {
+        invalid.emplace_back(offset, c);
+    });
+    for (const Chunk &chunk: chunks) {
+        if (position >= chunk.end) {
+            // an earlier re-lex already went past this chunk
+            continue;
+        }
+        // re-lex until the sequential scanner starts a call where (and in the mode) the chunk started one
+        relexer.seek(position);
+        relexer.set_mode(mode);
+        auto synced = chunk.call_starts.end();
+        while (position < chunk.end) {
+            synced = std::lower_bound(chunk.call_starts.begin(), chunk.call_starts.end(), position);
+            if (synced != chunk.call_starts.end() && *synced == position &&
+                chunk.call_modes[synced - chunk.call_starts.begin()] == mode) {
+                break;
+            }
+            synced = chunk.call_starts.end();
+            Token token = relexer.next();
+            position = relexer.position();
+            mode = relexer.mode();
+            if (token.is_end()) {
+                break;
+            }
+            stream.kinds.push_back(token.kind);
+            stream.offsets.push_back(token.offset);
+            stream.lengths.push_back(token.length);
+            stream.symbols.push_back(token.symbol);
+            stream.values.push_back(token.value);
+        }
+        if (synced != chunk.call_starts.end()) {
+            append(chunk, synced - chunk.call_starts.begin());
+            position = chunk.stop;
+            mode = chunk.stop_mode;
+        }
+    }
+
+    if (!this->symbol_table) {
+        stream.symbols.clear();
+    }
+    if (this->numeric_tokens.empty()) {
+        stream.values.clear();
+    }
+    for (const auto &entry: invalid) {
+        this->diagnostics.invalid_input(entry.first, entry.second);
+    }
+    if (!this->diagnostics.empty()) {
+        LineIndex lines(program);
+        this->diagnostics.flush([&lines](std::uint64_t offset) { return lines.locate(offset); });
+    }
+    return stream;
+}
@@ -0,0 +1,90 @@
+#ifndef COMPILER_PROJECT_PARALLELLEXER_H
+#define COMPILER_PROJECT_PARALLELLEXER_H
+
+
+#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "CompiledDFA.h"
+#include "Diagnostics.h"
+#include "ScannerCursor.h"
+#include "ScannerTables.h"
+#include "SymbolTable.h"
+#include "Token.h"
+#include "TokenTable.h"
+
+/**
+ * This class lexes one large in-memory program on several threads.
+ *
+ * The program is split into chunks and every chunk is lexed on its own thread by a ScannerCursor (all of them over
+ * the same ScannerTables) that starts at the first byte of the chunk, a guess of where a token starts. The chunks are then stitched in order: the scanner
+ * is deterministic between two calls of next() (what it returns only depends on where the call starts and in which
+ * mode), so once the true sequence of scan positions reaches a position where the guessed chunk (which guesses the
+ * INITIAL mode) also started a call in the same mode, the rest of the chunk is exactly what a sequential run would
+ * produce. Only the prefix before that position is re-lexed.
+ *
+ * The tokens and the invalid input reports (recorded in order once the chunks are stitched) are identical to the
+ * ones of Predictor::tokenize_all() on the whole program.
+ * With intern(), all the threads intern into the same SymbolTable (lexemes of a guessed prefix that is re-lexed
+ * may be interned too, they just get symbols no token refers to).
+ */
+class ParallelLexer {
+public:
+    // The smallest chunk worth its own thread.
+    static constexpr std::size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+    // threads 0 uses std::thread::hardware_concurrency().
+    ParallelLexer(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+                  std::size_t threads = 0);
+
+    // Interns the lexemes of the tokens named token_name, see Predictor::intern().
+    void intern(const std::string &token_name, std::shared_ptr<SymbolTable> table);
+
+    // Decodes the lexemes of the tokens named token_name, see Predictor::decode_numbers().
+    void decode_numbers(const std::string &token_name);
+
+    // Lexes the whole program, it must stay alive for the whole call.
+    TokenStream tokenize_all(std::string_view program);
+
+    // Returns the errors of the runs, written at the end of every tokenize_all().
+    Diagnostics &get_diagnostics();
+
+    // Returns the table that maps the kinds of the tokens to their names.
+    [[nodiscard]] const TokenTable &get_token_table() const;
+
+private:
+    // what a thread found in its chunk, one entry of calls per call of next()
+    struct Chunk {
+        std::uint64_t begin{};
+        std::uint64_t end{};
+        // where each call of next() started scanning, in which mode, and the number of invalid bytes reported before it.
+        // Call i returned token i (the last call may have returned no token, at the end of the program).
+        std::vector<std::uint64_t> call_starts{};
+        std::vector<std::size_t> call_modes{};
+        std::vector<std::size_t> call_invalid{};
+        TokenStream tokens{};
+        std::vector<std::pair<std::uint64_t, char>> invalid{};
+        // where the first call that wasn't made (it would have started at or past end) would start
+        std::uint64_t stop{};
+        std::size_t stop_mode{};
+    };
+
+    // Lexes the calls of next() that start in [chunk.begin, chunk.end).
+    void lex_chunk(std::string_view program, Chunk &chunk) const;
+
+    // Creates a cursor over the program with the interned and decoded tokens.
+    ScannerCursor make_cursor(std::string_view program) const;
+
+    // shared by the cursors of all the threads
+    std::shared_ptr<const ScannerTables> tables{};
+    std::size_t threads{};
+    std::shared_ptr<SymbolTable> symbol_table{};
+    std::vector<std::string> interned_tokens{};
+    std::vector<std::string> numeric_tokens{};
+    Diagnostics diagnostics{};
+};
+
+
+#endif
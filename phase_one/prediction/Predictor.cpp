@@ -1,21 +1,77 @@
 #include <fstream>
 #include <utility>
-#include <vector>
-#include <algorithm>
 #include <sstream>
-#include <stack>
-#include <limits>
 #include "Predictor.h"
 
 Predictor::Predictor(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
-                     const std::string &program_text) {
-    this->index = 0;
-    this->program = read_file(program_text);
-    this->automaton = a;
-    this->priorities = priorities;
+                     const std::string &program_text)
+        : Predictor(a, priorities, program_text == "-" ? SourceBuffer::from_fd(0)
+                                                       : SourceBuffer::map_file(program_text)) {
+}
+
+Predictor::Predictor(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+                     std::shared_ptr<SourceBuffer> source)
+        : Predictor(std::make_shared<const ScannerTables>(a, priorities), std::move(source)) {
+}
+
+Predictor::Predictor(CompiledModes modes, const TokenTable &token_table, std::shared_ptr<SourceBuffer> source)
+        : Predictor(std::make_shared<const ScannerTables>(std::move(modes), token_table), std::move(source)) {
+}
+
+Predictor::Predictor(std::shared_ptr<const ScannerTables> tables, std::shared_ptr<SourceBuffer> source)
+        : tables(std::move(tables)), cursor(*this->tables, std::move(source)) {
+}
+
+void Predictor::set_invalid_input_handler(InvalidInputHandler handler) {
+    this->cursor.set_invalid_input_handler(std::move(handler));
+}
+
+Diagnostics &Predictor::get_diagnostics() {
+    return this->cursor.get_diagnostics();
+}
+
+void Predictor::flush_diagnostics() {
+    this->cursor.flush_diagnostics();
+}
+
+SourcePosition Predictor::locate(std::uint64_t offset) {
+    return this->cursor.locate(offset);
+}
+
+void Predictor::intern(const std::string &token_name, std::shared_ptr<SymbolTable> table) {
+    this->cursor.intern(token_name, std::move(table));
+}
+
+void Predictor::decode_numbers(const std::string &token_name) {
+    this->cursor.decode_numbers(token_name);
+}
+
+bool Predictor::is_streaming() const {
+    return this->cursor.is_streaming();
+}
+
+std::uint64_t Predictor::position() const {
+    return this->cursor.position();
+}
 
-    find_dead_states();
+std::uint64_t Predictor::examined_end() const {
+    return this->cursor.examined_end();
+}
+
+std::size_t Predictor::mode() const {
+    return this->cursor.mode();
+}
+
+void Predictor::set_mode(std::size_t mode) {
+    this->cursor.set_mode(mode);
+}
+
+void Predictor::expect(const std::vector<bool> &kinds) {
+    this->cursor.expect(kinds);
+}
 
+void Predictor::seek(std::uint64_t offset) {
+    this->cursor.seek(offset);
 }
 
 // In read_file. i.e. reading the program
@@ -37,76 +93,38 @@ std::string Predictor::read_file(const std::string &file_name) {
 }
 
 
+Token Predictor::next() {
+    return this->cursor.next();
+}
+
+TokenRange Predictor::tokens() {
+    return this->cursor.tokens();
+}
+
+std::string_view Predictor::lexeme(const Token &token) const {
+    return this->cursor.lexeme(token);
+}
+
+const TokenTable &Predictor::get_token_table() const {
+    return this->cursor.get_token_table();
+}
+
+std::size_t Predictor::tokenize_batch(const TokenBatch &batch) {
+    return this->cursor.tokenize_batch(batch);
+}
+
+TokenStream Predictor::tokenize_all() {
+    return this->cursor.tokenize_all();
+}
+
+const std::shared_ptr<const ScannerTables> &Predictor::get_tables() const {
+    return this->tables;
+}
+
 std::pair<std::string, std::string> Predictor::next_token() {
-    std::shared_ptr<State> current_state_ptr = this->automaton->get_start();
-    std::stack<std::pair<std::string, std::string>> token_stack{};
-    std::string token{};
-    while (this->index < this->program.size()) {
-        char c = this->program[this->index];
-        if (std::isspace(static_cast<unsigned char>(c))) {
-            index++;
-            break;
-        }
-        if (this->automaton->get_alphabets().find(std::string(1, c)) == this->automaton->get_alphabets().end()) {
-            // this character isn't in the allowed alphabets
-            std::cout << "\033[1;31mError: Invalid input\033[0m" << ", ignoring character:'" << c << "'" << std::endl;
-            index++;
-            continue;
-        }
-        // character is appended to the end of the token as we now know that it isn't a space character or end on input.
-        token += std::string(1, c);
-        std::shared_ptr<State> next_state_ptr = *this->automaton->get_next_states(current_state_ptr,
-                                                                                  std::string(1, c)).begin();
-        // If next state is dead state
-        if (this->dead_states.find(next_state_ptr) != this->dead_states.end()) {
-            break;
-        }
-
-        // If next state is accepting state
-        if (this->automaton->is_accepting_state(next_state_ptr)) {
-            Types::string_set_t tokens = this->automaton->get_tokens(next_state_ptr);
-            int max_priority = std::numeric_limits<int>::min();
-            std::string chosen_token{};
-            for (const std::string &t: tokens) {
-                int new_priority = this->priorities.at(t);
-                if (max_priority < new_priority) {
-                    max_priority = new_priority;
-                    chosen_token = t;
-                }
-            }
-            token_stack.emplace(chosen_token, token);
-        }
-        current_state_ptr = next_state_ptr;
-        this->index++;
-    }
-    if (token_stack.empty()) {
-        if (this->index < this->program.size()) {
-            return this->next_token();
-        }
-        // done with the program
+    Token token = this->cursor.next();
+    if (token.is_end()) {
         return std::make_pair("", "");
     }
-    return token_stack.top();
-}
-
-void Predictor::find_dead_states() {
-    // Iterate over all states in the automaton
-    for (const std::shared_ptr<State> &state_ptr: this->automaton->get_states()) {
-        // Dead state can't be a start state or an accepting state.
-        if (!this->automaton->is_accepting_state(state_ptr) && this->automaton->get_start() != state_ptr) {
-            // Check if all outgoing transitions lead to the same state
-            bool is_dead_state = true;
-            for (const std::string &symbol: this->automaton->get_alphabets()) {
-                std::shared_ptr<State> next_state_ptr = *this->automaton->get_next_states(state_ptr, symbol).begin();
-                if (next_state_ptr != state_ptr) {
-                    is_dead_state = false;
-                    break;
-                }
-            }
-            // If all transitions lead to the same state, it's a dead state
-            if (is_dead_state) {
-                this->dead_states.insert(state_ptr);
-            }
-        }
-    }
-}
\ No newline at end of file
+    return std::make_pair(this->get_token_table().name(token.kind), std::string(this->cursor.lexeme(token)));
+}
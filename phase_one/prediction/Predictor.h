@@ -2,30 +2,96 @@
 #define COMPILER_PROJECT_PREDICTOR_H
 
 
+#include <functional>
 #include <map>
+#include <string_view>
 #include "../automaton/Automaton.h"
+#include "CompiledDFA.h"
+#include "Diagnostics.h"
+#include "LineIndex.h"
+#include "ScannerCursor.h"
+#include "ScannerTables.h"
+#include "SourceBuffer.h"
+#include "SymbolTable.h"
+#include "Token.h"
+#include "TokenRange.h"
+#include "TokenTable.h"
 
+/**
+ * This class scans one program: it is a ScannerTables (shared, see get_tables()) and a ScannerCursor over the program
+ * behind one object, for the callers that scan a single program. To scan many programs with the same tables
+ * (e.g. one per thread), build the ScannerTables once and give it to every Predictor, or use ScannerCursors directly.
+ */
 class Predictor {
 public:
+    // program_path "-" streams the program from stdin.
     Predictor(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
               const std::string &program_path);
 
-    std::pair<std::string, std::string> next_token();
+    // scans a program that is already in memory (mapped file, caller-owned view or owned string) in place,
+    // or a streaming buffer through its refill window.
+    Predictor(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+              std::shared_ptr<SourceBuffer> source);
 
-    static std::string read_file(const std::string &file_name);
+    // scans with already compiled DFAs (one per mode), they can't be specialized by expect().
+    Predictor(CompiledModes modes, const TokenTable &token_table, std::shared_ptr<SourceBuffer> source);
+
+    // scans with tables shared with other Predictors.
+    Predictor(std::shared_ptr<const ScannerTables> tables, std::shared_ptr<SourceBuffer> source);
+
+    using InvalidInputHandler = ScannerCursor::InvalidInputHandler;
+
+    // see ScannerCursor for all the methods below.
+
+    void set_invalid_input_handler(InvalidInputHandler handler);
+
+    Diagnostics &get_diagnostics();
+
+    void flush_diagnostics();
+
+    SourcePosition locate(std::uint64_t offset);
+
+    void intern(const std::string &token_name, std::shared_ptr<SymbolTable> table);
+
+    void decode_numbers(const std::string &token_name);
+
+    [[nodiscard]] bool is_streaming() const;
+
+    [[nodiscard]] std::uint64_t position() const;
 
-    void find_dead_states();
+    [[nodiscard]] std::uint64_t examined_end() const;
 
+    [[nodiscard]] std::size_t mode() const;
 
+    void set_mode(std::size_t mode);
+
+    void expect(const std::vector<bool> &kinds);
+
+    void seek(std::uint64_t offset);
+
+    Token next();
+
+    TokenRange tokens();
+
+    [[nodiscard]] std::string_view lexeme(const Token &token) const;
+
+    [[nodiscard]] const TokenTable &get_token_table() const;
+
+    std::size_t tokenize_batch(const TokenBatch &batch);
+
+    TokenStream tokenize_all();
+
+    // Returns the tables, to scan other programs with them.
+    [[nodiscard]] const std::shared_ptr<const ScannerTables> &get_tables() const;
+
+    // Returns (token name, lexeme) of the next token, or ("", "") once the program is consumed.
+    std::pair<std::string, std::string> next_token();
+
+    static std::string read_file(const std::string &file_name);
 
 private:
-    std::shared_ptr<Automaton> automaton{};
-    std::vector<std::vector<std::shared_ptr<State>>> matrix{};
-    std::map<std::string, int> priorities{};
-    std::vector<std::string> symbols{};
-    Types::state_set_t dead_states{};
-    std::string program{};
-    int index{};
+    std::shared_ptr<const ScannerTables> tables;
+    ScannerCursor cursor;
 };
 
 
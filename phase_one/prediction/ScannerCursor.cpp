@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "ScannerCursor.h"
+
+ScannerCursor::ScannerCursor(const ScannerTables &tables, std::shared_ptr<SourceBuffer> source) : tables(tables) {
+    this->source = std::move(source);
+    this->program = this->source->view();
+    this->window_base = this->source->window_begin();
+    this->selected_dfa = this->tables.get_mode(0);
+    this->dfa = this->selected_dfa;
+    this->failed = FailedStates(this->dfa->state_count());
+}
+
+void ScannerCursor::set_invalid_input_handler(InvalidInputHandler handler) {
+    this->invalid_input = std::move(handler);
+}
+
+Diagnostics &ScannerCursor::get_diagnostics() {
+    return this->diagnostics;
+}
+
+void ScannerCursor::flush_diagnostics() {
+    this->diagnostics.flush([this](std::uint64_t offset) { return this->locate(offset); });
+}
+
+SourcePosition ScannerCursor::locate(std::uint64_t offset) {
+    this->index_lines();
+    return this->lines.locate(offset);
+}
+
+void ScannerCursor::index_lines() {
+    std::uint64_t window_end = this->window_base + this->program.size();
+    if (this->lines.end() < window_end) {
+        this->lines.add(this->program.substr(this->lines.end() - this->window_base), this->lines.end());
+    }
+}
+
+void ScannerCursor::intern(const std::string &token_name, std::shared_ptr<SymbolTable> table) {
+    if (this->symbol_table && this->symbol_table != table) {
+        throw std::runtime_error("All interned tokens must share one SymbolTable");
+    }
+    this->symbol_table = std::move(table);
+    this->interned_kinds.resize(this->tables.get_token_table().size(), false);
+    this->interned_kinds[this->tables.get_token_table().id(token_name)] = true;
+}
+
+void ScannerCursor::decode_numbers(const std::string &token_name) {
+    this->numeric_kinds.resize(this->tables.get_token_table().size(), false);
+    this->numeric_kinds[this->tables.get_token_table().id(token_name)] = true;
+}
+
+bool ScannerCursor::is_streaming() const {
+    return this->source->is_streaming();
+}
+
+std::uint64_t ScannerCursor::position() const {
+    return this->index;
+}
+
+std::uint64_t ScannerCursor::examined_end() const {
+    return this->examined;
+}
+
+std::size_t ScannerCursor::mode() const {
+    return this->current_mode;
+}
+
+void ScannerCursor::set_mode(std::size_t mode) {
+    if (mode >= this->tables.mode_count()) {
+        throw std::runtime_error("Unknown mode: " + std::to_string(mode));
+    }
+    this->current_mode = mode;
+    this->select_dfa();
+}
+
+void ScannerCursor::expect(const std::vector<bool> &kinds) {
+    if (kinds == this->expected) {
+        return;
+    }
+    if (!kinds.empty() && !this->tables.can_specialize()) {
+        throw std::runtime_error("Parser-directed scanning needs ScannerTables built from the automaton");
+    }
+    this->expected = kinds;
+    this->select_dfa();
+}
+
+void ScannerCursor::select_dfa() {
+    std::shared_ptr<const CompiledDFA> selected = this->tables.get_mode(this->current_mode);
+    if (!this->expected.empty()) {
+        // a memo of the cursor's own in front of the shared cache, so switching sets doesn't take its lock
+        std::shared_ptr<const CompiledDFA> &cached = this->expected_dfas[{this->current_mode, this->expected}];
+        if (!cached) {
+            cached = this->tables.specialize(this->current_mode, this->expected);
+        }
+        selected = cached;
+    }
+    this->selected_dfa = selected;
+    if (this->dfa != selected) {
+        this->dfa = selected;
+        // the states in the memo belong to the old DFA
+        this->failed = FailedStates(this->dfa->state_count());
+    }
+}
+
+void ScannerCursor::seek(std::uint64_t offset) {
+    if (this->source->is_streaming()) {
+        throw std::runtime_error("Can't seek in a streaming program");
+    }
+    this->index = offset;
+    // the memo is only valid for the scans that produced it
+    this->failed = FailedStates(this->dfa->state_count());
+    this->examined = offset;
+}
+
+Token ScannerCursor::next() {
+    bool falling_back = false;
+    // characters that start no token are skipped by looping (not recursing), so long runs of them are fine.
+    while (true) {
+        if (falling_back) {
+            falling_back = false;
+        } else if (this->dfa != this->selected_dfa) {
+            // the last token was scanned with the full DFA, go back to the expected kinds
+            this->dfa = this->selected_dfa;
+            this->failed = FailedStates(this->dfa->state_count());
+        }
+        // skip the separators before the token a vector at a time
+        while (true) {
+            if (!this->has_input(this->index)) {
+                // done with the program, finding its end counts as looking at one more position
+                this->examined = std::max(this->examined, this->index + 1);
+                this->flush_diagnostics();
+                return {Token::END_OF_INPUT, 0, this->index};
+            }
+            const char *begin = this->program.data() + (this->index - this->window_base);
+            const char *end = this->program.data() + this->program.size();
+            const char *found = this->dfa->get_separators().find_first_not_in(begin, end);
+            this->index += found - begin;
+            if (found != end) {
+                break;
+            }
+        }
+        // the bytes of this token must stay in the window while it is scanned and rolled back
+        std::uint64_t token_start = this->index;
+        std::int32_t state = this->dfa->start_state();
+        // only the longest accepted prefix is remembered
+        std::uint32_t accepted_kind = Token::END_OF_INPUT;
+        std::uint64_t accepted_end = token_start;
+        this->failed.clear_trail();
+        while (this->has_input(token_start)) {
+            std::size_t offset = this->index - this->window_base;
+            auto c = static_cast<unsigned char>(this->program[offset]);
+            // an earlier scan already went on from here without accepting anything
+            if (this->failed.contains(state, this->index)) {
+                break;
+            }
+            std::int32_t previous = state;
+            std::int32_t next_state = CompiledDFA::DEAD;
+            // two bytes per lookup while the memo has nothing ahead, the table has no pair through an accepting state
+            if (this->dfa->has_pair_table() && offset + 1 < this->program.size() && this->index >= this->failed.limit()) {
+                const CompiledDFA::PairStep &step =
+                        this->dfa->next_pair(state, c, static_cast<unsigned char>(this->program[offset + 1]));
+                if (step.last != CompiledDFA::DEAD) {
+                    this->index++;
+                    this->failed.extend_trail(step.middle, this->index, this->index);
+                    previous = step.middle;
+                    next_state = step.last;
+                }
+            }
+            if (next_state == CompiledDFA::DEAD) {
+                // spaces and characters outside the alphabets have no transitions, so they end the token too
+                next_state = this->dfa->next(state, c);
+                if (next_state == CompiledDFA::DEAD) {
+                    break;
+                }
+            }
+            bool looped = next_state == previous;
+            state = next_state;
+            this->index++;
+            std::uint64_t run_first = this->index;
+            const ByteSet *loop = looped ? this->dfa->self_loop(state) : nullptr;
+            // the second time around a self-loop, skip the rest of the run with one scan instead of a transition
+            // per byte. Every byte of the run ends in the same state, so only its end matters for the longest match,
+            // the memo has nothing past failed_limit.
+            if (loop != nullptr && this->index >= this->failed.limit()) {
+                const char *begin = this->program.data() + (this->index - this->window_base);
+                const char *end = this->program.data() + this->program.size();
+                this->index += loop->find_first_not_in(begin, end) - begin;
+            }
+
+            // the token of an accepting state was resolved when the DFA was built
+            std::uint32_t kind = this->dfa->accepting_kind(state);
+            if (kind != CompiledDFA::NOT_ACCEPTING) {
+                accepted_kind = kind;
+                accepted_end = this->index;
+                this->failed.clear_trail();
+            } else {
+                this->failed.extend_trail(state, run_first, this->index);
+            }
+        }
+        this->failed.remember(token_start);
+        // the byte the scan stopped on was looked at (or the end of the program, or a memo entry made further on)
+        this->examined = std::max(this->examined, this->index + 1);
+
+        if (accepted_kind != Token::END_OF_INPUT) {
+            // rewind once, to the end of the longest match
+            this->index = accepted_end;
+            Token token{accepted_kind, static_cast<std::uint32_t>(accepted_end - token_start), token_start};
+            // a keyword left to the perfect hash
+            token.kind = this->dfa->reclassify(accepted_kind, this->lexeme(token));
+            bool skip = this->dfa->is_skip(token.kind);
+            std::int32_t target = this->dfa->mode_switch(token.kind);
+            if (target != CompiledDFA::KEEP_MODE) {
+                this->set_mode(static_cast<std::size_t>(target));
+            }
+            if (skip) {
+                // whitespace or a comment, go on with the next token without returning
+                continue;
+            }
+            if (token.kind < this->interned_kinds.size() && this->interned_kinds[token.kind]) {
+                // the lexeme was just scanned, so it is still in the cache when it is hashed
+                token.symbol = this->symbol_table->intern(this->lexeme(token));
+            }
+            if (token.kind < this->numeric_kinds.size() && this->numeric_kinds[token.kind]) {
+                // same as interning, the digits are read again while they are still in the cache
+                NumberDecoder::decode(this->lexeme(token), token.value);
+            }
+            return token;
+        }
+
+        // no token starts here
+        this->index = token_start;
+        if (this->dfa != this->tables.get_mode(this->current_mode)) {
+            // no expected one at least, scan it again with every token
+            this->dfa = this->tables.get_mode(this->current_mode);
+            this->failed = FailedStates(this->dfa->state_count());
+            falling_back = true;
+            continue;
+        }
+        const char *begin = this->program.data() + (this->index - this->window_base);
+        const char *end = begin + 1;
+        if (!this->dfa->in_alphabet(static_cast<unsigned char>(*begin))) {
+            // skip the whole run of bytes outside the alphabets
+            end = this->dfa->get_recognised().find_first_in(begin, this->program.data() + this->program.size());
+        }
+        for (const char *p = begin; p < end; p++) {
+            std::uint64_t offset = this->index + (p - begin);
+            if (this->invalid_input) {
+                this->invalid_input(offset, *p);
+            } else {
+                this->diagnostics.invalid_input(offset, *p);
+            }
+        }
+        this->index += end - begin;
+        this->examined = std::max(this->examined, this->index + 1);
+    }
+}
+
+TokenRange ScannerCursor::tokens() {
+    return TokenRange(this);
+}
+
+std::string_view ScannerCursor::lexeme(const Token &token) const {
+    return this->program.substr(token.offset - this->window_base, token.length);
+}
+
+const TokenTable &ScannerCursor::get_token_table() const {
+    return this->tables.get_token_table();
+}
+
+std::size_t ScannerCursor::tokenize_batch(const TokenBatch &batch) {
+    std::size_t count = 0;
+    while (count < batch.capacity) {
+        Token token = this->next();
+        if (token.is_end()) {
+            break;
+        }
+        batch.kinds[count] = token.kind;
+        batch.offsets[count] = token.offset;
+        batch.lengths[count] = token.length;
+        if (batch.symbols != nullptr) {
+            batch.symbols[count] = token.symbol;
+        }
+        if (batch.values != nullptr) {
+            batch.values[count] = token.value;
+        }
+        count++;
+    }
+    return count;
+}
+
+TokenStream ScannerCursor::tokenize_all() {
+    TokenStream stream{};
+    // a streaming program has no known length, it starts from one window worth of tokens
+    std::size_t remaining = this->source->is_streaming() ? SourceBuffer::DEFAULT_WINDOW_CAPACITY
+                                                         : this->program.size() - (this->index - this->window_base);
+    std::size_t capacity = remaining / ESTIMATED_BYTES_PER_TOKEN + 16;
+    std::size_t count = 0;
+    while (true) {
+        stream.kinds.resize(capacity);
+        stream.offsets.resize(capacity);
+        stream.lengths.resize(capacity);
+        TokenBatch batch{stream.kinds.data() + count, stream.offsets.data() + count, stream.lengths.data() + count,
+                         capacity - count};
+        if (this->symbol_table) {
+            stream.symbols.resize(capacity);
+            batch.symbols = stream.symbols.data() + count;
+        }
+        if (!this->numeric_kinds.empty()) {
+            stream.values.resize(capacity);
+            batch.values = stream.values.data() + count;
+        }
+        std::size_t written = this->tokenize_batch(batch);
+        count += written;
+        if (written < batch.capacity) {
+            break;
+        }
+        capacity *= 2;
+    }
+    stream.kinds.resize(count);
+    stream.offsets.resize(count);
+    stream.lengths.resize(count);
+    if (this->symbol_table) {
+        stream.symbols.resize(count);
+    }
+    if (!this->numeric_kinds.empty()) {
+        stream.values.resize(count);
+    }
+    return stream;
+}
+bool ScannerCursor::has_input(std::uint64_t keep_from) {
+    if (this->index - this->window_base < this->program.size()) {
+        return true;
+    }
+    if (this->source->is_streaming()) {
+        // the refill may drop bytes whose lines a later diagnostic needs
+        this->index_lines();
+    }
+    bool refilled = this->source->refill(keep_from);
+    this->program = this->source->view();
+    this->window_base = this->source->window_begin();
+    return refilled && this->index - this->window_base < this->program.size();
+}
@@ -0,0 +1,156 @@
+#ifndef COMPILER_PROJECT_SCANNERCURSOR_H
+#define COMPILER_PROJECT_SCANNERCURSOR_H
+
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string_view>
+#include "CompiledDFA.h"
+#include "Diagnostics.h"
+#include "FailedStates.h"
+#include "LineIndex.h"
+#include "NumberDecoder.h"
+#include "ScannerTables.h"
+#include "SourceBuffer.h"
+#include "SymbolTable.h"
+#include "Token.h"
+#include "TokenRange.h"
+#include "TokenTable.h"
+
+/**
+ * This class scans one program with a ScannerTables: it holds everything that changes while scanning (where it is,
+ * the mode, the memo of failed states, the errors) and only reads the tables, so it is cheap to make one per program
+ * and cursors on different threads can share the same tables.
+ * The tables must outlive the cursor.
+ */
+class ScannerCursor {
+public:
+    // scans a program that is already in memory (mapped file, caller-owned view or owned string) in place,
+    // or a streaming buffer through its refill window.
+    ScannerCursor(const ScannerTables &tables, std::shared_ptr<SourceBuffer> source);
+
+    // Called for every byte that is skipped because no token starts with it, with its absolute offset.
+    // Without one the bytes are recorded in get_diagnostics().
+    using InvalidInputHandler = std::function<void(std::uint64_t, char)>;
+
+    void set_invalid_input_handler(InvalidInputHandler handler);
+
+    // Returns the errors of the scan, e.g. to choose where they are written.
+    Diagnostics &get_diagnostics();
+
+    // Writes the errors recorded so far, done once by next() when it reaches the end of the program.
+    void flush_diagnostics();
+
+    /**
+     * Returns the line and column of an offset the cursor scanned (e.g. of a token), for diagnostics.
+     * The lines of an in-memory program are only indexed the first time this is called, so scanning a program
+     * without errors never looks for newlines. A streaming program is indexed window by window as it is read.
+     */
+    SourcePosition locate(std::uint64_t offset);
+
+    // Interns the lexemes of the tokens named token_name (e.g. "id") in table, their tokens carry the symbol.
+    // It can be called for several token names, they must all use the same table.
+    void intern(const std::string &token_name, std::shared_ptr<SymbolTable> table);
+
+    // Decodes the lexemes of the tokens named token_name (e.g. "num"), their tokens carry the value
+    // (see NumberDecoder). It can be called for several token names.
+    void decode_numbers(const std::string &token_name);
+
+    // Returns whether the program is streamed, see SourceBuffer::is_streaming().
+    [[nodiscard]] bool is_streaming() const;
+
+    // Returns the absolute offset where the next call to next() starts scanning.
+    [[nodiscard]] std::uint64_t position() const;
+
+    // Returns one past the furthest offset the tokens returned so far depend on (the end of the program counts as
+    // one more byte). Editing the program from there on can't change them, see IncrementalLexer.
+    [[nodiscard]] std::uint64_t examined_end() const;
+
+    // Returns the mode (start condition) the next call to next() scans in, 0 is INITIAL.
+    [[nodiscard]] std::size_t mode() const;
+
+    // Scans in another mode from now on, the tokens declared with %switch change it too.
+    void set_mode(std::size_t mode);
+
+    /**
+     * Parser-directed scanning: the next tokens are scanned with a DFA specialized to the expected kinds (indexed by
+     * kind, see ScannerTables::specialize()). Where no expected token starts, the token is scanned with the full DFA
+     * so the parser sees what is there. An empty vector goes back to scanning every token.
+     * Needs tables built from the automaton.
+     */
+    void expect(const std::vector<bool> &kinds);
+
+    // Moves the scanner to an absolute offset of an in-memory program, next() will scan from there.
+    void seek(std::uint64_t offset);
+
+    // Returns the next token, or a token of kind Token::END_OF_INPUT once the program is consumed.
+    Token next();
+
+    // Returns the rest of the tokens as a lazy range, e.g. for (const Token &token: cursor.tokens()).
+    TokenRange tokens();
+
+    // Returns the lexeme of a token returned by next().
+    // For a streaming program it stays valid only until the next call to next().
+    [[nodiscard]] std::string_view lexeme(const Token &token) const;
+
+    // Returns the table that maps the kinds of the tokens to their names.
+    [[nodiscard]] const TokenTable &get_token_table() const;
+
+    /**
+     * Scans up to batch.capacity tokens into the arrays of the batch.
+     *
+     * @return the number of tokens written, less than the capacity only at the end of the program (0 once it is consumed).
+     */
+    std::size_t tokenize_batch(const TokenBatch &batch);
+
+    // Scans the rest of the program, the arrays are pre-sized from the length of the program.
+    TokenStream tokenize_all();
+
+private:
+    // the guess of the bytes per token used to pre-size tokenize_all()
+    static constexpr std::size_t ESTIMATED_BYTES_PER_TOKEN = 4;
+
+    // Picks the DFA of the current mode and expected kinds, the memo is reset if it changes.
+    void select_dfa();
+
+    // Indexes the lines of the bytes of the window that aren't indexed yet.
+    void index_lines();
+
+    // true if there is a byte at this->index, refilling a streaming source (keeping bytes from keep_from) if needed.
+    bool has_input(std::uint64_t keep_from);
+
+
+    const ScannerTables &tables;
+    std::size_t current_mode{};
+    std::vector<bool> expected{};
+    std::map<std::pair<std::size_t, std::vector<bool>>, std::shared_ptr<const CompiledDFA>> expected_dfas{};
+    // the DFA of the current mode and expected kinds, and the one scanning (the full DFA of the mode while
+    // falling back)
+    std::shared_ptr<const CompiledDFA> selected_dfa{};
+    std::shared_ptr<const CompiledDFA> dfa{};
+    // empty records in diagnostics
+    InvalidInputHandler invalid_input{};
+    Diagnostics diagnostics{};
+    LineIndex lines{};
+    // the table of intern(), and which kinds are interned in it (indexed by kind)
+    std::shared_ptr<SymbolTable> symbol_table{};
+    std::vector<bool> interned_kinds{};
+    // the kinds of decode_numbers() (indexed by kind)
+    std::vector<bool> numeric_kinds{};
+    std::shared_ptr<SourceBuffer> source{};
+    // the window of the program currently available, program[0] is at offset window_base.
+    std::string_view program{};
+    std::uint64_t window_base{};
+    // absolute offset of the next byte to scan.
+    std::uint64_t index{};
+    // see examined_end()
+    std::uint64_t examined{};
+
+    // the failed (state, position) pairs, scanning stops on them, which keeps maximal munch linear
+    // even when every token rolls back a long way.
+    FailedStates failed{};
+};
+
+
+#endif
@@ -0,0 +1,49 @@
+#include <stdexcept>
+#include <utility>
+#include "ScannerTables.h"
+
+ScannerTables::ScannerTables(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+                             std::size_t pair_table_budget) {
+    this->token_table = TokenTable(priorities);
+    this->modes = CompiledDFA::compile_modes(a, this->token_table, pair_table_budget);
+    this->automaton = a;
+    this->pair_table_budget = pair_table_budget;
+}
+
+ScannerTables::ScannerTables(CompiledModes modes, TokenTable token_table) {
+    this->token_table = std::move(token_table);
+    this->modes = std::move(modes);
+}
+
+const TokenTable &ScannerTables::get_token_table() const {
+    return this->token_table;
+}
+
+std::size_t ScannerTables::mode_count() const {
+    return this->modes.size();
+}
+
+const std::shared_ptr<const CompiledDFA> &ScannerTables::get_mode(std::size_t mode) const {
+    if (mode >= this->modes.size()) {
+        throw std::runtime_error("Unknown mode: " + std::to_string(mode));
+    }
+    return this->modes[mode];
+}
+
+bool ScannerTables::can_specialize() const {
+    return static_cast<bool>(this->automaton);
+}
+
+std::shared_ptr<const CompiledDFA> ScannerTables::specialize(std::size_t mode, const std::vector<bool> &kinds) const {
+    if (!this->automaton) {
+        throw std::runtime_error("Parser-directed scanning needs ScannerTables built from the automaton");
+    }
+    std::lock_guard<std::mutex> lock(this->specialized_mutex);
+    std::shared_ptr<const CompiledDFA> &cached = this->specialized[{mode, kinds}];
+    if (!cached) {
+        // compiled under the lock, so two cursors expecting the same set don't both build it
+        std::shared_ptr<Automaton> a = this->automaton;
+        cached = CompiledDFA::compile_expected(a, mode, this->token_table, kinds, this->pair_table_budget);
+    }
+    return cached;
+}
@@ -0,0 +1,63 @@
+#ifndef COMPILER_PROJECT_SCANNERTABLES_H
+#define COMPILER_PROJECT_SCANNERTABLES_H
+
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../automaton/Automaton.h"
+#include "CompiledDFA.h"
+#include "TokenTable.h"
+
+/**
+ * This class holds what a scanner needs that doesn't depend on the program: the token table and the compiled DFA of
+ * every mode. It is built once and never changes, so any number of ScannerCursors, on any threads, can scan
+ * with one ScannerTables through a const reference.
+ *
+ * The DFAs specialized to a set of expected kinds (see ScannerCursor::expect()) are compiled the first time a cursor
+ * asks for them and shared from then on, that cache is the only state and is guarded by a mutex.
+ */
+class ScannerTables {
+public:
+    // the largest stride-2 table worth building, past this the two-byte lookups miss the cache and stride 1 wins.
+    static constexpr std::size_t PAIR_TABLE_BUDGET = 256 * 1024;
+
+    // Compiles the modes of the automaton, it is kept to specialize them.
+    ScannerTables(std::shared_ptr<Automaton> &a, const std::map<std::string, int> &priorities,
+                  std::size_t pair_table_budget = PAIR_TABLE_BUDGET);
+
+    // Uses already compiled DFAs (one per mode), they can't be specialized.
+    ScannerTables(CompiledModes modes, TokenTable token_table);
+
+    ScannerTables(const ScannerTables &) = delete;
+
+    ScannerTables &operator=(const ScannerTables &) = delete;
+
+    // Returns the table that maps the kinds of the tokens to their names.
+    [[nodiscard]] const TokenTable &get_token_table() const;
+
+    // Returns the number of modes, INITIAL is mode 0.
+    [[nodiscard]] std::size_t mode_count() const;
+
+    // Returns the DFA of a mode.
+    [[nodiscard]] const std::shared_ptr<const CompiledDFA> &get_mode(std::size_t mode) const;
+
+    // Returns whether specialize() can be called (the tables were built from the automaton).
+    [[nodiscard]] bool can_specialize() const;
+
+    // Returns the DFA of a mode specialized to the expected kinds (indexed by kind), compiling it the first time.
+    [[nodiscard]] std::shared_ptr<const CompiledDFA> specialize(std::size_t mode, const std::vector<bool> &kinds) const;
+
+private:
+    TokenTable token_table{};
+    CompiledModes modes{};
+    std::shared_ptr<Automaton> automaton{};
+    std::size_t pair_table_budget{};
+    mutable std::mutex specialized_mutex{};
+    mutable std::map<std::pair<std::size_t, std::vector<bool>>, std::shared_ptr<const CompiledDFA>> specialized{};
+};
+
+
+#endif
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "SourceBuffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define COMPILER_PROJECT_HAS_POSIX 1
+#endif
+
+std::shared_ptr<SourceBuffer> SourceBuffer::map_file(const std::string &file_name) {
+#ifdef COMPILER_PROJECT_HAS_POSIX
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + file_name);
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + file_name);
+    }
+    if (!S_ISREG(st.st_mode)) {
+        // pipes and devices have no size to map, read them through a window instead.
+        std::shared_ptr<SourceBuffer> buffer = from_fd(fd);
+        buffer->owned_fd = fd;
+        return buffer;
+    }
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        // mmap refuses zero-length mappings, an empty program is just an empty view.
+        ::close(fd);
+        return buffer;
+    }
+    void *address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file: " + file_name);
+    }
+    // the scanner walks the program front to back exactly once
+    ::madvise(address, size, MADV_SEQUENTIAL);
+    ::madvise(address, size, MADV_WILLNEED);
+    buffer->mapping = address;
+    buffer->mapping_size = size;
+    buffer->contents = std::string_view(static_cast<const char *>(address), size);
+    return buffer;
+#else
+    std::ifstream inFile(file_name, std::ios::binary);
+    if (!inFile) {
+        throw std::runtime_error("Failed to open file: " + file_name);
+    }
+    std::stringstream ss;
+    ss << inFile.rdbuf();
+    return from_string(ss.str());
+#endif
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::from_string(std::string contents) {
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->owned = std::move(contents);
+    buffer->contents = buffer->owned;
+    return buffer;
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::from_view(std::string_view contents) {
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->contents = contents;
+    return buffer;
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::from_stream(std::istream &stream, std::size_t capacity) {
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->window.resize(std::max<std::size_t>(capacity, 1));
+    buffer->reader = [&stream](char *destination, std::size_t count) -> std::size_t {
+        stream.read(destination, static_cast<std::streamsize>(count));
+        return static_cast<std::size_t>(stream.gcount());
+    };
+    buffer->contents = std::string_view(buffer->window.data(), 0);
+    return buffer;
+}
+
+std::shared_ptr<SourceBuffer> SourceBuffer::from_fd(int fd, std::size_t capacity) {
+#ifdef COMPILER_PROJECT_HAS_POSIX
+    std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->window.resize(std::max<std::size_t>(capacity, 1));
+    buffer->reader = [fd](char *destination, std::size_t count) -> std::size_t {
+        while (true) {
+            ssize_t n = ::read(fd, destination, count);
+            if (n >= 0) {
+                return static_cast<std::size_t>(n);
+            }
+            if (errno != EINTR) {
+                throw std::runtime_error(std::string("Failed to read program: ") + std::strerror(errno));
+            }
+        }
+    };
+    buffer->contents = std::string_view(buffer->window.data(), 0);
+    return buffer;
+#else
+    throw std::runtime_error("Reading from a file descriptor isn't supported on this platform");
+#endif
+}
+
+SourceBuffer::~SourceBuffer() {
+#ifdef COMPILER_PROJECT_HAS_POSIX
+    if (this->mapping != nullptr) {
+        ::munmap(this->mapping, this->mapping_size);
+    }
+    if (this->owned_fd >= 0) {
+        ::close(this->owned_fd);
+    }
+#endif
+}
+
+std::string_view SourceBuffer::view() const {
+    return this->contents;
+}
+
+std::size_t SourceBuffer::size() const {
+    return this->contents.size();
+}
+
+std::uint64_t SourceBuffer::window_begin() const {
+    return this->window_base;
+}
+
+bool SourceBuffer::is_streaming() const {
+    return static_cast<bool>(this->reader);
+}
+
+bool SourceBuffer::refill(std::uint64_t keep_from) {
+    if (!this->reader || this->exhausted) {
+        return false;
+    }
+    std::size_t live = this->contents.size();
+    if (keep_from > this->window_base) {
+        // drop the bytes the scanner will never look at again
+        auto discard = static_cast<std::size_t>(std::min<std::uint64_t>(keep_from - this->window_base, live));
+        live -= discard;
+        std::memmove(this->window.data(), this->window.data() + discard, live);
+        this->window_base += discard;
+    }
+    if (live == this->window.size()) {
+        // a single token fills the whole window, it has to grow to hold it.
+        this->window.resize(this->window.size() * 2);
+    }
+    std::size_t n = this->reader(this->window.data() + live, this->window.size() - live);
+    this->contents = std::string_view(this->window.data(), live + n);
+    if (n == 0) {
+        this->exhausted = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+#ifndef COMPILER_PROJECT_SOURCEBUFFER_H
+#define COMPILER_PROJECT_SOURCEBUFFER_H
+
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * This class holds the bytes of the program that the Predictor scans.
+ * The bytes are one of:
+ *  - a read-only memory mapping of a file (no copy of the file is ever made),
+ *  - a string owned by the buffer,
+ *  - a view over memory owned by the caller, which must outlive the buffer,
+ *  - a bounded window over a stream (std::istream, pipe or file descriptor) that is refilled on demand.
+ *
+ * Offsets are 64-bit and absolute (from the start of the program), view() is the window of bytes
+ * currently available and starts at window_begin(). For the in-memory kinds the window is the whole program.
+ *
+ * remember to create buffers with the static factories, they return std::shared_ptr<SourceBuffer>
+ * so that the Predictor and its caller can share the same bytes.
+ */
+class SourceBuffer {
+public:
+    // The default size of the refill window of streaming buffers.
+    static constexpr std::size_t DEFAULT_WINDOW_CAPACITY = 64 * 1024;
+
+    // Maps the file read-only and advises the kernel that it will be read sequentially.
+    // Files that can't be mapped (pipes, character devices) are streamed instead.
+    static std::shared_ptr<SourceBuffer> map_file(const std::string &file_name);
+
+    // Takes ownership of an in-memory program.
+    static std::shared_ptr<SourceBuffer> from_string(std::string contents);
+
+    // Scans caller-owned memory in place.
+    static std::shared_ptr<SourceBuffer> from_view(std::string_view contents);
+
+    // Streams the program from a std::istream, the stream must outlive the buffer.
+    static std::shared_ptr<SourceBuffer> from_stream(std::istream &stream,
+                                                     std::size_t capacity = DEFAULT_WINDOW_CAPACITY);
+
+    // Streams the program from a file descriptor (e.g. 0 for stdin), the descriptor isn't closed by the buffer.
+    static std::shared_ptr<SourceBuffer> from_fd(int fd, std::size_t capacity = DEFAULT_WINDOW_CAPACITY);
+
+    SourceBuffer(const SourceBuffer &) = delete;
+
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    ~SourceBuffer();
+
+    // Returns the bytes currently available, view()[0] is at offset window_begin() of the program.
+    [[nodiscard]] std::string_view view() const;
+
+    // Returns the number of bytes currently available.
+    [[nodiscard]] std::size_t size() const;
+
+    // Returns the absolute offset of the first byte of view().
+    [[nodiscard]] std::uint64_t window_begin() const;
+
+    // Returns whether the bytes come from a stream (and so view() is only a window of the program).
+    [[nodiscard]] bool is_streaming() const;
+
+    /**
+     * Makes more bytes of a streaming program available.
+     * Bytes before keep_from may be discarded, the ones from keep_from on stay in the window so a token that
+     * straddles the refill (and the rollback to its longest match) can still be scanned.
+     * If nothing before keep_from can be discarded the window grows, so it is bounded by
+     * max(capacity, longest token).
+     *
+     * @return false when the end of the program was reached (always false for the in-memory kinds).
+     */
+    bool refill(std::uint64_t keep_from);
+
+private:
+    SourceBuffer() = default;
+
+    // The memory mapping (if any) and its length.
+    void *mapping{};
+    std::size_t mapping_size{};
+
+    // The program when it is owned by the buffer.
+    std::string owned{};
+
+    // The bytes that are scanned, points into one of the above, the window, or into caller-owned memory.
+    std::string_view contents{};
+
+    // Streaming state: the window storage, the offset of its first byte, and where the bytes come from.
+    std::vector<char> window{};
+    std::uint64_t window_base{};
+    std::function<std::size_t(char *, std::size_t)> reader{};
+    bool exhausted{};
+    // a descriptor opened by map_file() for a file that couldn't be mapped
+    int owned_fd = -1;
+};
+
+
+#endif
@@ -0,0 +1,70 @@
+#include <stdexcept>
+#include "SymbolTable.h"
+
+std::uint64_t SymbolTable::hash(std::string_view lexeme) {
+    std::uint64_t h = 14695981039346656037ULL;
+    for (char c: lexeme) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::uint32_t SymbolTable::intern(std::string_view lexeme, std::uint64_t lexeme_hash) {
+    // the low bits pick the stripe, the rest the slot
+    Stripe &stripe = this->stripes[lexeme_hash & (STRIPES - 1)];
+    std::uint64_t slot_hash = lexeme_hash >> STRIPE_BITS;
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    if ((stripe.names.size() + 1) * 2 > stripe.slots.size()) {
+        grow(stripe);
+    }
+    std::size_t mask = stripe.slots.size() - 1;
+    std::size_t slot = slot_hash & mask;
+    while (stripe.slots[slot] != 0) {
+        std::uint32_t local = stripe.slots[slot] - 1;
+        if (stripe.hashes[local] == lexeme_hash && stripe.names[local] == lexeme) {
+            return local << STRIPE_BITS | static_cast<std::uint32_t>(lexeme_hash & (STRIPES - 1));
+        }
+        slot = (slot + 1) & mask;
+    }
+    auto local = static_cast<std::uint32_t>(stripe.names.size());
+    if (local >= (std::uint32_t{1} << (32 - STRIPE_BITS)) - 1) {
+        throw std::runtime_error("Too many symbols");
+    }
+    stripe.names.emplace_back(lexeme);
+    stripe.hashes.push_back(lexeme_hash);
+    stripe.slots[slot] = local + 1;
+    return local << STRIPE_BITS | static_cast<std::uint32_t>(lexeme_hash & (STRIPES - 1));
+}
+
+const std::string &SymbolTable::name(std::uint32_t symbol) const {
+    const Stripe &stripe = this->stripes[symbol & (STRIPES - 1)];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    std::uint32_t local = symbol >> STRIPE_BITS;
+    if (local >= stripe.names.size()) {
+        throw std::runtime_error("Unknown symbol: " + std::to_string(symbol));
+    }
+    return stripe.names[local];
+}
+
+std::size_t SymbolTable::size() const {
+    std::size_t count = 0;
+    for (const Stripe &stripe: this->stripes) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        count += stripe.names.size();
+    }
+    return count;
+}
+
+void SymbolTable::grow(Stripe &stripe) {
+    std::vector<std::uint32_t> slots(stripe.slots.empty() ? 16 : stripe.slots.size() * 2, 0);
+    std::size_t mask = slots.size() - 1;
+    for (std::uint32_t local = 0; local < stripe.names.size(); local++) {
+        std::size_t slot = (stripe.hashes[local] >> STRIPE_BITS) & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = local + 1;
+    }
+    stripe.slots = std::move(slots);
+}
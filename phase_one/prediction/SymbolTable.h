@@ -0,0 +1,65 @@
+#ifndef COMPILER_PROJECT_SYMBOLTABLE_H
+#define COMPILER_PROJECT_SYMBOLTABLE_H
+
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * This class interns lexemes (identifiers): every distinct lexeme gets a 32-bit symbol id that never changes,
+ * so later phases compare and hash integers instead of strings.
+ *
+ * It can be shared by the threads of a parallel lexing run. The table is split into STRIPES independent
+ * stripes, each with its own lock, picked by the hash of the lexeme, so threads interning different lexemes
+ * rarely wait for each other. A symbol id is (index in its stripe << STRIPE_BITS) | stripe, which makes the ids
+ * stable without any shared counter (they aren't dense).
+ */
+class SymbolTable {
+public:
+    static constexpr std::uint32_t STRIPE_BITS = 6;
+    static constexpr std::size_t STRIPES = std::size_t{1} << STRIPE_BITS;
+
+    SymbolTable() = default;
+
+    SymbolTable(const SymbolTable &) = delete;
+
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    // The hash used by intern(), FNV-1a.
+    static std::uint64_t hash(std::string_view lexeme);
+
+    // Returns the symbol of the lexeme, adding it if it is new.
+    std::uint32_t intern(std::string_view lexeme) { return this->intern(lexeme, hash(lexeme)); }
+
+    // Same as intern(lexeme) with the hash already computed by hash(lexeme).
+    std::uint32_t intern(std::string_view lexeme, std::uint64_t lexeme_hash);
+
+    // Returns the lexeme of a symbol returned by intern(), the reference stays valid as long as the table.
+    [[nodiscard]] const std::string &name(std::uint32_t symbol) const;
+
+    // Returns the number of interned lexemes.
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    struct Stripe {
+        mutable std::mutex mutex{};
+        // the lexemes by index in the stripe, a deque so name() references survive insertions
+        std::deque<std::string> names{};
+        std::vector<std::uint64_t> hashes{};
+        // open addressing: index in the stripe + 1, 0 is an empty slot
+        std::vector<std::uint32_t> slots{};
+    };
+
+    // doubles the slots of a stripe (the stripe lock is held)
+    static void grow(Stripe &stripe);
+
+    std::array<Stripe, STRIPES> stripes{};
+};
+
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef COMPILER_PROJECT_TOKEN_H
+#define COMPILER_PROJECT_TOKEN_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The decoded value of a numeric token (see Predictor::decode_numbers()), `type` tells which member holds it.
+ */
+struct NumericValue {
+    enum Type : std::uint8_t {
+        NONE, INTEGER, REAL
+    };
+
+    Type type = NONE;
+    union {
+        std::int64_t integer;
+        double real;
+    };
+
+    NumericValue() : integer(0) {}
+};
+
+/**
+ * A token found by the Predictor.
+ * It doesn't own its lexeme: the lexeme is the `length` bytes of the program starting at `offset`,
+ * use Predictor::lexeme() to get it as a std::string_view and TokenTable::name() to get the token name.
+ */
+struct Token {
+    // The kind returned once the whole program was consumed.
+    static constexpr std::uint32_t END_OF_INPUT = UINT32_MAX;
+    // The symbol of a token whose lexeme isn't interned.
+    static constexpr std::uint32_t NO_SYMBOL = UINT32_MAX;
+
+    // The dense id of the token name in the TokenTable.
+    std::uint32_t kind;
+    // The number of bytes of the lexeme.
+    std::uint32_t length;
+    // The absolute offset of the first byte of the lexeme in the program.
+    std::uint64_t offset;
+    // The id of the lexeme in the SymbolTable, for the kinds the Predictor interns (see Predictor::intern()).
+    std::uint32_t symbol = NO_SYMBOL;
+    // The value of the lexeme, for the kinds the Predictor decodes (see Predictor::decode_numbers()).
+    NumericValue value{};
+
+    [[nodiscard]] bool is_end() const { return kind == END_OF_INPUT; }
+};
+
+/**
+ * Caller-provided storage, as a structure of arrays, that Predictor::tokenize_batch() fills with up to
+ * `capacity` tokens: token i is (kinds[i], offsets[i], lengths[i]), and symbols[i] (values[i]) unless symbols (values)
+ * is nullptr.
+ */
+struct TokenBatch {
+    std::uint32_t *kinds;
+    std::uint64_t *offsets;
+    std::uint32_t *lengths;
+    std::size_t capacity;
+    std::uint32_t *symbols = nullptr;
+    NumericValue *values = nullptr;
+};
+
+/**
+ * The tokens of a whole program as a structure of arrays, returned by Predictor::tokenize_all().
+ */
+struct TokenStream {
+    std::vector<std::uint32_t> kinds{};
+    std::vector<std::uint64_t> offsets{};
+    std::vector<std::uint32_t> lengths{};
+    // empty when nothing is interned
+    std::vector<std::uint32_t> symbols{};
+    // empty when nothing is decoded
+    std::vector<NumericValue> values{};
+
+    [[nodiscard]] std::size_t size() const { return kinds.size(); }
+
+    [[nodiscard]] Token operator[](std::size_t i) const {
+        return {kinds[i], lengths[i], offsets[i], symbols.empty() ? Token::NO_SYMBOL : symbols[i],
+                values.empty() ? NumericValue{} : values[i]};
+    }
+};
+
+
+#endif
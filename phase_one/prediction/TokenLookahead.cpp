@@ -0,0 +1,109 @@
+#include <algorithm>
+#include "TokenLookahead.h"
+
+TokenLookahead::TokenLookahead(std::shared_ptr<Predictor> predictor, std::size_t capacity) {
+    this->predictor = std::move(predictor);
+    this->on_demand = this->predictor->is_streaming();
+    std::size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    this->mask = size - 1;
+    this->kinds.resize(size);
+    this->offsets.resize(size);
+    this->lengths.resize(size);
+    this->symbols.resize(size);
+    this->values.resize(size);
+}
+
+void TokenLookahead::scan_on_demand() {
+    this->on_demand = true;
+}
+
+Token TokenLookahead::peek(std::size_t k) {
+    this->refill(k);
+    std::uint64_t index = this->current + k;
+    if (index >= this->filled) {
+        return {Token::END_OF_INPUT, 0, this->end_offset};
+    }
+    std::size_t slot = index & this->mask;
+    return {this->kinds[slot], this->lengths[slot], this->offsets[slot], this->symbols[slot], this->values[slot]};
+}
+
+Token TokenLookahead::consume() {
+    Token token = this->peek(0);
+    if (!token.is_end()) {
+        this->current++;
+    }
+    return token;
+}
+
+void TokenLookahead::mark() {
+    this->has_mark = true;
+    this->marked = this->current;
+}
+
+void TokenLookahead::reset() {
+    if (this->has_mark) {
+        this->current = this->marked;
+    }
+}
+
+void TokenLookahead::release() {
+    this->has_mark = false;
+}
+
+std::string_view TokenLookahead::lexeme(const Token &token) const {
+    return this->predictor->lexeme(token);
+}
+
+Predictor &TokenLookahead::get_predictor() const {
+    return *this->predictor;
+}
+
+void TokenLookahead::refill(std::size_t needed) {
+    while (!this->ended && this->filled - this->current <= needed) {
+        std::size_t capacity = this->mask + 1;
+        if (this->filled - this->retained() == capacity) {
+            this->grow();
+            continue;
+        }
+        // the free slots up to the end of the array (the ring wraps on the next refill)
+        std::size_t slot = this->filled & this->mask;
+        std::size_t room = std::min(capacity - (this->filled - this->retained()), capacity - slot);
+        if (this->on_demand) {
+            room = 1;
+        }
+        TokenBatch batch{this->kinds.data() + slot, this->offsets.data() + slot, this->lengths.data() + slot, room,
+                         this->symbols.data() + slot, this->values.data() + slot};
+        std::size_t written = this->predictor->tokenize_batch(batch);
+        this->filled += written;
+        if (written < room) {
+            this->ended = true;
+            this->end_offset = this->predictor->position();
+        }
+    }
+}
+
+void TokenLookahead::grow() {
+    std::size_t size = (this->mask + 1) * 2;
+    std::size_t new_mask = size - 1;
+    std::vector<std::uint32_t> new_kinds(size), new_lengths(size), new_symbols(size);
+    std::vector<std::uint64_t> new_offsets(size);
+    std::vector<NumericValue> new_values(size);
+    for (std::uint64_t index = this->retained(); index < this->filled; index++) {
+        std::size_t from = index & this->mask;
+        std::size_t to = index & new_mask;
+        new_kinds[to] = this->kinds[from];
+        new_offsets[to] = this->offsets[from];
+        new_lengths[to] = this->lengths[from];
+        new_symbols[to] = this->symbols[from];
+        new_values[to] = this->values[from];
+    }
+    this->kinds = std::move(new_kinds);
+    this->offsets = std::move(new_offsets);
+    this->lengths = std::move(new_lengths);
+    this->symbols = std::move(new_symbols);
+    this->values = std::move(new_values);
+    this->mask = new_mask;
+}
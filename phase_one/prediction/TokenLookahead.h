@@ -0,0 +1,84 @@
+#ifndef COMPILER_PROJECT_TOKENLOOKAHEAD_H
+#define COMPILER_PROJECT_TOKENLOOKAHEAD_H
+
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "Predictor.h"
+#include "Token.h"
+
+/**
+ * This class is a ring of scanned tokens between a Predictor and its consumer (the Parser), so the consumer
+ * can look several tokens ahead and backtrack without scanning anything twice.
+ *
+ * The ring is a structure of arrays that Predictor::tokenize_batch() fills directly, as many tokens as there is
+ * room for at a time. Tokens are addressed by their absolute index in the program, a slot is index & (capacity - 1),
+ * so nothing is ever moved. The ring only grows when a mark keeps more tokens than it can hold.
+ *
+ * Scanning ahead in batches is wrong when the scanner changes between tokens (Predictor::expect()) and a streaming
+ * program only keeps the lexeme of the last token, in both cases scan_on_demand() scans only what peek() needs.
+ */
+class TokenLookahead {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 256;
+
+    // capacity is rounded up to a power of two.
+    explicit TokenLookahead(std::shared_ptr<Predictor> predictor, std::size_t capacity = DEFAULT_CAPACITY);
+
+    // Scans only the tokens peek() and consume() need, it is the default for a streaming program.
+    void scan_on_demand();
+
+    // Returns the k-th token after the current one (0 is the current one), a token of kind END_OF_INPUT
+    // (at the end of the program) past the last one.
+    Token peek(std::size_t k = 0);
+
+    // Returns the current token and moves to the next one.
+    Token consume();
+
+    // Remembers the current token, it and the tokens after it stay in the ring until release().
+    // A new mark replaces the previous one.
+    void mark();
+
+    // Goes back to the marked token, the mark stays.
+    void reset();
+
+    // Forgets the mark.
+    void release();
+
+    // Returns the lexeme of a token of the ring.
+    [[nodiscard]] std::string_view lexeme(const Token &token) const;
+
+    [[nodiscard]] Predictor &get_predictor() const;
+
+private:
+    // Scans until the ring holds more than `needed` tokens from the current one, or the program is consumed.
+    void refill(std::size_t needed);
+
+    // Doubles the ring, keeping every token where its index says.
+    void grow();
+
+    // Returns the first token that has to stay in the ring.
+    [[nodiscard]] std::uint64_t retained() const { return this->has_mark ? this->marked : this->current; }
+
+    std::shared_ptr<Predictor> predictor{};
+    bool on_demand{};
+    std::size_t mask{};
+    std::vector<std::uint32_t> kinds{};
+    std::vector<std::uint64_t> offsets{};
+    std::vector<std::uint32_t> lengths{};
+    std::vector<std::uint32_t> symbols{};
+    std::vector<NumericValue> values{};
+    // the absolute indices of the current token and of the first token not scanned yet
+    std::uint64_t current{};
+    std::uint64_t filled{};
+    bool has_mark{};
+    std::uint64_t marked{};
+    // set once the Predictor returned the end of the program, which is at end_offset
+    bool ended{};
+    std::uint64_t end_offset{};
+};
+
+
+#endif
@@ -0,0 +1,21 @@
+#include "TokenRange.h"
+#include "ScannerCursor.h"
+
+TokenIterator::TokenIterator(ScannerCursor *cursor) {
+    this->cursor = cursor;
+    ++*this;
+}
+
+TokenIterator &TokenIterator::operator++() {
+    this->current = this->cursor->next();
+    if (this->current.is_end()) {
+        this->cursor = nullptr;
+    }
+    return *this;
+}
+
+Token TokenIterator::operator++(int) {
+    Token previous = this->current;
+    ++*this;
+    return previous;
+}
@@ -0,0 +1,67 @@
+#ifndef COMPILER_PROJECT_TOKENRANGE_H
+#define COMPILER_PROJECT_TOKENRANGE_H
+
+
+#include <cstddef>
+#include <iterator>
+#include "Token.h"
+
+class ScannerCursor;
+
+/**
+ * An input iterator over the tokens of a ScannerCursor, every increment is one call of ScannerCursor::next().
+ * The default-constructed iterator is the end, the one reached when next() returns END_OF_INPUT.
+ */
+class TokenIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Token;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Token *;
+    using reference = const Token &;
+
+    TokenIterator() = default;
+
+    // Reads the first token.
+    explicit TokenIterator(ScannerCursor *cursor);
+
+    reference operator*() const { return this->current; }
+
+    pointer operator->() const { return &this->current; }
+
+    TokenIterator &operator++();
+
+    // The previous token is returned, the iterator itself can't be rewound.
+    Token operator++(int);
+
+    // Iterators are only equal when both are at the end (it is an input iterator, there is one pass).
+    bool operator==(const TokenIterator &other) const { return this->at_end() && other.at_end(); }
+
+    bool operator!=(const TokenIterator &other) const { return !(*this == other); }
+
+private:
+    [[nodiscard]] bool at_end() const { return this->cursor == nullptr; }
+
+    ScannerCursor *cursor{};
+    Token current{Token::END_OF_INPUT, 0, 0};
+};
+
+/**
+ * The rest of the tokens of a ScannerCursor (or Predictor) as a range, so `for (const Token &token: cursor.tokens())`
+ * and the standard algorithms scan the program lazily, one token at a time, without collecting them anywhere.
+ * The range can be iterated once and the cursor must outlive it.
+ */
+class TokenRange {
+public:
+    explicit TokenRange(ScannerCursor *cursor) : cursor(cursor) {}
+
+    [[nodiscard]] TokenIterator begin() const { return TokenIterator(this->cursor); }
+
+    [[nodiscard]] TokenIterator end() const { return {}; }
+
+private:
+    ScannerCursor *cursor;
+};
+
+
+#endif
@@ -0,0 +1,196 @@
+#include <cstring>
+#include <stdexcept>
+#include "TokenStreamFile.h"
+#include "Predictor.h"
+
+namespace {
+    constexpr char MAGIC[8] = {'C', 'P', 'T', 'O', 'K', 'E', 'N', '1'};
+    // written as is, a reader on a host of the other byte order sees 0x04030201
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr std::size_t RECORD_SIZE = 16;
+    // the lexeme of a token is found from the anchor of its group by adding the lengths of the tokens before it
+    constexpr std::size_t LEXEME_ANCHOR_STRIDE = 64;
+    constexpr std::size_t TOKENS_PER_BATCH = 4096;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t byte_order;
+        std::uint32_t name_count;
+        std::uint64_t token_count;
+        std::uint64_t records_offset;
+        std::uint64_t anchors_offset;
+        std::uint64_t lexemes_offset;
+        std::uint64_t lexemes_size;
+    };
+
+    std::uint64_t align(std::uint64_t offset) {
+        return (offset + 7) & ~static_cast<std::uint64_t>(7);
+    }
+
+    template<typename T>
+    T load(const char *address) {
+        T value;
+        std::memcpy(&value, address, sizeof(T));
+        return value;
+    }
+}
+
+TokenStreamWriter::TokenStreamWriter(const std::string &file_name, const TokenTable &token_table) {
+    this->file_name = file_name;
+    this->file.open(file_name, std::ios::binary | std::ios::trunc);
+    if (!this->file) {
+        throw std::runtime_error("Failed to open file: " + file_name);
+    }
+    // the header is written again by close(), once the sizes are known
+    Header header{};
+    this->file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    std::string names{};
+    for (std::uint32_t kind = 0; kind < token_table.size(); kind++) {
+        names += token_table.name(kind);
+        names += '\0';
+    }
+    names.resize(align(sizeof(Header) + names.size()) - sizeof(Header), '\0');
+    this->file.write(names.data(), static_cast<std::streamsize>(names.size()));
+    this->name_count = static_cast<std::uint32_t>(token_table.size());
+    this->records_offset = sizeof(Header) + names.size();
+    this->records.resize(BUFFER_SIZE);
+}
+
+TokenStreamWriter::~TokenStreamWriter() {
+    if (!this->closed) {
+        try {
+            this->close();
+        } catch (const std::exception &) {
+        }
+    }
+}
+
+void TokenStreamWriter::write(const Token &token, std::string_view lexeme) {
+    if (this->token_count % LEXEME_ANCHOR_STRIDE == 0) {
+        this->anchors.push_back(this->lexemes.size());
+    }
+    if (this->buffered + RECORD_SIZE > this->records.size()) {
+        this->flush_records();
+    }
+    char *record = this->records.data() + this->buffered;
+    std::memcpy(record, &token.kind, 4);
+    std::memcpy(record + 4, &token.length, 4);
+    std::memcpy(record + 8, &token.offset, 8);
+    this->buffered += RECORD_SIZE;
+    this->lexemes.append(lexeme);
+    this->token_count++;
+}
+
+void TokenStreamWriter::write_all(Predictor &predictor) {
+    if (predictor.is_streaming()) {
+        // only the lexeme of the last token is kept, the tokens are written one at a time
+        for (const Token &token: predictor.tokens()) {
+            this->write(token, predictor.lexeme(token));
+        }
+        return;
+    }
+    std::vector<std::uint32_t> kinds(TOKENS_PER_BATCH);
+    std::vector<std::uint64_t> offsets(TOKENS_PER_BATCH);
+    std::vector<std::uint32_t> lengths(TOKENS_PER_BATCH);
+    TokenBatch batch{kinds.data(), offsets.data(), lengths.data(), TOKENS_PER_BATCH};
+    std::size_t written;
+    while ((written = predictor.tokenize_batch(batch)) != 0) {
+        for (std::size_t i = 0; i < written; i++) {
+            Token token{kinds[i], lengths[i], offsets[i]};
+            this->write(token, predictor.lexeme(token));
+        }
+    }
+}
+
+void TokenStreamWriter::close() {
+    this->closed = true;
+    this->flush_records();
+    this->records = std::vector<char>();
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.byte_order = BYTE_ORDER_MARK;
+    header.name_count = this->name_count;
+    header.token_count = this->token_count;
+    header.records_offset = this->records_offset;
+    header.anchors_offset = this->records_offset + this->token_count * RECORD_SIZE;
+    header.lexemes_offset = header.anchors_offset + this->anchors.size() * sizeof(std::uint64_t);
+    header.lexemes_size = this->lexemes.size();
+    this->file.write(reinterpret_cast<const char *>(this->anchors.data()),
+                     static_cast<std::streamsize>(this->anchors.size() * sizeof(std::uint64_t)));
+    this->file.write(this->lexemes.data(), static_cast<std::streamsize>(this->lexemes.size()));
+    this->lexemes = std::string();
+    this->file.seekp(0);
+    this->file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    this->file.close();
+    if (this->file.fail()) {
+        throw std::runtime_error("Failed to write file: " + this->file_name);
+    }
+}
+
+void TokenStreamWriter::flush_records() {
+    this->file.write(this->records.data(), static_cast<std::streamsize>(this->buffered));
+    this->buffered = 0;
+}
+
+TokenStreamReader::TokenStreamReader(const std::string &file_name) {
+    this->mapping = SourceBuffer::map_file(file_name);
+    if (this->mapping->is_streaming()) {
+        throw std::runtime_error("Failed to map file: " + file_name);
+    }
+    std::string_view bytes = this->mapping->view();
+    const std::runtime_error invalid("Invalid token stream file: " + file_name);
+    if (bytes.size() < sizeof(Header)) {
+        throw invalid;
+    }
+    auto header = load<Header>(bytes.data());
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.byte_order != BYTE_ORDER_MARK) {
+        throw invalid;
+    }
+    std::uint64_t anchor_count = (header.token_count + LEXEME_ANCHOR_STRIDE - 1) / LEXEME_ANCHOR_STRIDE;
+    if (header.records_offset > bytes.size() ||
+        header.token_count > (bytes.size() - header.records_offset) / RECORD_SIZE ||
+        header.anchors_offset != header.records_offset + header.token_count * RECORD_SIZE ||
+        header.lexemes_offset != header.anchors_offset + anchor_count * sizeof(std::uint64_t) ||
+        header.lexemes_offset > bytes.size() || header.lexemes_size != bytes.size() - header.lexemes_offset) {
+        throw invalid;
+    }
+    std::size_t position = sizeof(Header);
+    for (std::uint32_t kind = 0; kind < header.name_count; kind++) {
+        std::size_t end = bytes.find('\0', position);
+        if (end == std::string_view::npos || end >= header.records_offset) {
+            throw invalid;
+        }
+        this->names.emplace_back(bytes.substr(position, end - position));
+        position = end + 1;
+    }
+    this->token_count = header.token_count;
+    this->records = bytes.data() + header.records_offset;
+    this->anchors = bytes.data() + header.anchors_offset;
+    this->lexemes = bytes.data() + header.lexemes_offset;
+}
+
+std::size_t TokenStreamReader::size() const {
+    return this->token_count;
+}
+
+Token TokenStreamReader::operator[](std::size_t i) const {
+    const char *record = this->records + i * RECORD_SIZE;
+    return {load<std::uint32_t>(record), load<std::uint32_t>(record + 4), load<std::uint64_t>(record + 8)};
+}
+
+std::string_view TokenStreamReader::lexeme(std::size_t i) const {
+    std::size_t group = i / LEXEME_ANCHOR_STRIDE;
+    auto start = load<std::uint64_t>(this->anchors + group * sizeof(std::uint64_t));
+    for (std::size_t j = group * LEXEME_ANCHOR_STRIDE; j < i; j++) {
+        start += load<std::uint32_t>(this->records + j * RECORD_SIZE + 4);
+    }
+    return {this->lexemes + start, load<std::uint32_t>(this->records + i * RECORD_SIZE + 4)};
+}
+
+const std::string &TokenStreamReader::name(std::uint32_t kind) const {
+    return this->names.at(kind);
+}
+
+std::size_t TokenStreamReader::name_count() const {
+    return this->names.size();
+}
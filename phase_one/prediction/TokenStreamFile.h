@@ -0,0 +1,101 @@
+#ifndef COMPILER_PROJECT_TOKENSTREAMFILE_H
+#define COMPILER_PROJECT_TOKENSTREAMFILE_H
+
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SourceBuffer.h"
+#include "Token.h"
+#include "TokenTable.h"
+
+class Predictor;
+
+/*
+ * A token stream file keeps every token of a program with its position and lexeme, in host byte order:
+ *  - a header (see TokenStreamFile.cpp) with the counts and the offsets of the sections,
+ *  - the token names, each one ending with '\0', the name of kind k is the k-th one,
+ *  - one fixed-width record per token: kind (4 bytes), length (4 bytes), offset in the program (8 bytes),
+ *  - the start of the lexeme of every 64th token in the lexeme section (8 bytes each),
+ *  - the lexemes, one after the other in the order of the tokens.
+ * Every section starts on an 8-byte boundary.
+ */
+
+/**
+ * This class writes a token stream file, through a large buffer of records so the file is written in a few big writes.
+ * The lexemes are kept in memory until close() (they come after the records), which patches the header.
+ */
+class TokenStreamWriter {
+public:
+    static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+    TokenStreamWriter(const std::string &file_name, const TokenTable &token_table);
+
+    TokenStreamWriter(const TokenStreamWriter &) = delete;
+
+    TokenStreamWriter &operator=(const TokenStreamWriter &) = delete;
+
+    // Closes the file if close() wasn't called, an error is lost then.
+    ~TokenStreamWriter();
+
+    void write(const Token &token, std::string_view lexeme);
+
+    // Writes the rest of the tokens of a Predictor, scanning them in batches unless its program is streamed.
+    void write_all(Predictor &predictor);
+
+    // Writes the lexemes and the header, throws if the file couldn't be written.
+    void close();
+
+private:
+    void flush_records();
+
+    std::string file_name{};
+    std::ofstream file{};
+    std::uint32_t name_count{};
+    std::vector<char> records{};
+    std::size_t buffered{};
+    std::uint64_t token_count{};
+    std::uint64_t records_offset{};
+    std::vector<std::uint64_t> anchors{};
+    std::string lexemes{};
+    bool closed{};
+};
+
+/**
+ * This class reads a token stream file in place from a read-only memory mapping, nothing is decoded up front
+ * apart from the token names.
+ */
+class TokenStreamReader {
+public:
+    // Maps the file, throws if it isn't a token stream file.
+    explicit TokenStreamReader(const std::string &file_name);
+
+    // Returns the number of tokens.
+    [[nodiscard]] std::size_t size() const;
+
+    // Returns the i-th token.
+    [[nodiscard]] Token operator[](std::size_t i) const;
+
+    // Returns the lexeme of the i-th token.
+    [[nodiscard]] std::string_view lexeme(std::size_t i) const;
+
+    // Returns the name of a token kind.
+    [[nodiscard]] const std::string &name(std::uint32_t kind) const;
+
+    // Returns the number of token names.
+    [[nodiscard]] std::size_t name_count() const;
+
+private:
+    std::shared_ptr<SourceBuffer> mapping{};
+    std::vector<std::string> names{};
+    std::size_t token_count{};
+    const char *records{};
+    const char *anchors{};
+    const char *lexemes{};
+};
+
+
+#endif
@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <stdexcept>
+#include "TokenTable.h"
+
+TokenTable::TokenTable(const std::map<std::string, int> &priorities) {
+    std::vector<std::pair<std::string, int>> sorted(priorities.begin(), priorities.end());
+    // highest priority first, the name breaks ties so the ids are stable
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const std::pair<std::string, int> &a, const std::pair<std::string, int> &b) {
+                         return a.second > b.second;
+                     });
+    this->names.reserve(sorted.size());
+    for (const auto &pair: sorted) {
+        this->ids[pair.first] = static_cast<std::uint32_t>(this->names.size());
+        this->names.push_back(pair.first);
+    }
+}
+
+std::uint32_t TokenTable::id(const std::string &name) const {
+    auto it = this->ids.find(name);
+    if (it == this->ids.end()) {
+        throw std::runtime_error("Unknown token: " + name);
+    }
+    return it->second;
+}
+
+std::uint32_t TokenTable::find(const std::string &name) const {
+    auto it = this->ids.find(name);
+    return (it == this->ids.end()) ? NO_TOKEN : it->second;
+}
+
+const std::string &TokenTable::name(std::uint32_t id) const {
+    return this->names.at(id);
+}
+
+std::size_t TokenTable::size() const {
+    return this->names.size();
+}
@@ -0,0 +1,43 @@
+#ifndef COMPILER_PROJECT_TOKENTABLE_H
+#define COMPILER_PROJECT_TOKENTABLE_H
+
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * This class maps token names to dense integer ids and back.
+ * It is derived from the priorities of LexicalRulesHandler: ids are given in decreasing priority,
+ * so the token with the highest priority gets id 0 and a smaller id always wins a tie between tokens.
+ */
+class TokenTable {
+public:
+    // The id returned by find() for a name that isn't a token.
+    static constexpr std::uint32_t NO_TOKEN = UINT32_MAX;
+
+    TokenTable() = default;
+
+    explicit TokenTable(const std::map<std::string, int> &priorities);
+
+    // Returns the id of a token name, throws if it isn't a token.
+    [[nodiscard]] std::uint32_t id(const std::string &name) const;
+
+    // Returns the id of a token name, or NO_TOKEN.
+    [[nodiscard]] std::uint32_t find(const std::string &name) const;
+
+    // Returns the name of a token id.
+    [[nodiscard]] const std::string &name(std::uint32_t id) const;
+
+    // Returns the number of tokens.
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    std::vector<std::string> names{};
+    std::unordered_map<std::string, std::uint32_t> ids{};
+};
+
+
+#endif
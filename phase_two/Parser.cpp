@@ -86,13 +86,53 @@ void Parser::parse(std::vector<std::string> tokens) {
 
 void Parser::parse(const std::shared_ptr<Predictor> &tokenizer, const std::string &parsing_tree_path,
                    const std::string &parsing_output_path) {
+    // the tokens are scanned ahead in batches, unless the scanner depends on what the parser expects
+    TokenLookahead lookahead(tokenizer);
+    if (this->directed_scanning) {
+        lookahead.scan_on_demand();
+    }
+    parse([&](const std::string &top) {
+              expect(tokenizer, top);
+              return get_next_token(lookahead);
+          },
+          [&](std::uint64_t offset) { return tokenizer->locate(offset); },
+          parsing_tree_path, parsing_output_path);
+}
+
+void Parser::parse(const TokenStreamReader &tokens, const std::shared_ptr<SourceBuffer> &program,
+                   const std::string &parsing_tree_path, const std::string &parsing_output_path) {
+    std::size_t next = 0;
+    // the lines are only indexed if there is an error to locate
+    std::unique_ptr<LineIndex> lines{};
+    parse([&](const std::string &) -> std::pair<std::string, std::string> {
+              if (next == tokens.size()) {
+                  this->input_offset = program->size();
+                  return {this->table->get_rules()->get_dollar_symbol(),
+                          this->table->get_rules()->get_dollar_symbol()};
+              }
+              Token token = tokens[next];
+              this->input_offset = token.offset;
+              return {tokens.name(token.kind), std::string(tokens.lexeme(next++))};
+          },
+          [&](std::uint64_t offset) {
+              if (!lines) {
+                  lines = std::make_unique<LineIndex>(program->view());
+              }
+              return lines->locate(offset);
+          },
+          parsing_tree_path, parsing_output_path);
+}
+
+void Parser::parse(const std::function<std::pair<std::string, std::string>(const std::string &)> &next_token,
+                   const std::function<SourcePosition(std::uint64_t)> &locate,
+                   const std::string &parsing_tree_path, const std::string &parsing_output_path) {
     std::stack<std::string> parseStack{};
     parseStack.emplace(this->table->get_rules()->get_dollar_symbol());
     parseStack.push(table->get_start_symbol());
 
     std::string top = parseStack.top();
     parseStack.pop();
-    std::pair<std::string, std::string> input_symbol = get_next_token(tokenizer);
+    std::pair<std::string, std::string> input_symbol = next_token(top);
     std::cout << "######################### parsing started #########################" << '\n';
     while (!parseStack.empty()) {
         if (table->is_terminal(top)) {
@@ -106,11 +146,12 @@ void Parser::parse(const std::shared_ptr<Predictor> &tokenizer, const std::strin
                     std::cout << GREEN << "Matched (" << top << ", " << input_symbol.second << ")" << RESET << '\n';
                     top = parseStack.top();
                     parseStack.pop();
-                    input_symbol = get_next_token(tokenizer);
+                    input_symbol = next_token(top);
                 }
             } else {
-                output_string(parsing_output_path, "Error: missing {" + top + "}. Inserted ");
-                std::cout << RED << "Error: missing {" << top << "}. Inserted " << RESET << '\n';
+                std::string position = input_position(locate);
+                output_string(parsing_output_path, "Error: missing {" + top + "} at " + position + ". Inserted ");
+                std::cout << RED << "Error: missing {" << top << "} at " << position << ". Inserted " << RESET << '\n';
                 top = parseStack.top();
                 parseStack.pop();
             }
@@ -119,10 +160,12 @@ void Parser::parse(const std::shared_ptr<Predictor> &tokenizer, const std::strin
             if (!rule.empty()) {
                 if ((rule.size() == 1) && (rule[0] == this->table->get_rules()->get_sync_symbol())) {
                     // sync
+                    std::string position = input_position(locate);
                     output_string(parsing_output_path,
-                                  "Error: " + this->table->get_rules()->get_sync_symbol() + " {" + top + "}");
+                                  "Error: " + this->table->get_rules()->get_sync_symbol() + " {" + top + "} at " +
+                                  position);
                     std::cout << RED << "Error: " << this->table->get_rules()->get_sync_symbol()
-                              << " {" << RESET << top << RED << "}"
+                              << " {" << RESET << top << RED << "} at " << position
                               << RESET << '\n';
                     top = parseStack.top();
                     parseStack.pop();
@@ -150,22 +193,60 @@ void Parser::parse(const std::shared_ptr<Predictor> &tokenizer, const std::strin
                     }
                 }
             } else {
-                output_string(parsing_output_path, "Error: ignoring " + input_symbol.first + " {" + input_symbol.second + "}");
+                std::string position = input_position(locate);
+                output_string(parsing_output_path,
+                              "Error: ignoring " + input_symbol.first + " {" + input_symbol.second + "} at " + position);
                 std::cout << RED << "Error: ignoring " << input_symbol.first << " {" << RESET << input_symbol.second
-                          << RED << "}" << RESET << '\n';
-                input_symbol = get_next_token(tokenizer);
+                          << RED << "} at " << position << RESET << '\n';
+                input_symbol = next_token(top);
             }
         }
     }
     std::cout << "########################### parsing ended #########################" << '\n';
 }
 
-std::pair<std::string, std::string> Parser::get_next_token(const std::shared_ptr<Predictor> &tokenizer) {
-    std::pair<std::string, std::string> entry = tokenizer->next_token();
-    if (entry.first.empty() && entry.second.empty()) {
+std::pair<std::string, std::string> Parser::get_next_token(TokenLookahead &lookahead) {
+    Token token = lookahead.consume();
+    this->input_offset = token.offset;
+    if (token.is_end()) {
         return {this->table->get_rules()->get_dollar_symbol(), this->table->get_rules()->get_dollar_symbol()};
     }
-    return entry;
+    return {lookahead.get_predictor().get_token_table().name(token.kind), std::string(lookahead.lexeme(token))};
+}
+
+std::string Parser::input_position(const std::function<SourcePosition(std::uint64_t)> &locate) const {
+    return locate(this->input_offset).to_string();
+}
+
+void Parser::set_directed_scanning(bool enabled) {
+    this->directed_scanning = enabled;
+}
+
+void Parser::expect(const std::shared_ptr<Predictor> &tokenizer, const std::string &top) {
+    if (!this->directed_scanning) {
+        return;
+    }
+    auto it = this->expected_kinds.find(top);
+    if (it == this->expected_kinds.end()) {
+        std::vector<std::string> terminals = table->is_terminal(top) ? std::vector<std::string>{top}
+                                                                     : table->get_expected_terminals(top);
+        const TokenTable &token_table = tokenizer->get_token_table();
+        std::vector<bool> kinds(token_table.size(), false);
+        bool any = false;
+        for (const std::string &terminal: terminals) {
+            std::uint32_t kind = token_table.find(terminal);
+            if (kind != TokenTable::NO_TOKEN) {
+                kinds[kind] = true;
+                any = true;
+            }
+        }
+        // nothing the tokenizer knows (e.g. only $ is left), scan every token
+        if (!any) {
+            kinds.clear();
+        }
+        it = this->expected_kinds.emplace(top, std::move(kinds)).first;
+    }
+    tokenizer->expect(it->second);
 }
 
 void Parser::output_string(const std::string &parsing_output_path, const std::string &output_string) {
@@ -1,10 +1,14 @@
 #ifndef COMPILER_PROJECT_PARSER_H
 #define COMPILER_PROJECT_PARSER_H
 
+#include <functional>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 #include "Table.h"
 #include "../phase_one/prediction/Predictor.h"
+#include "../phase_one/prediction/TokenLookahead.h"
+#include "../phase_one/prediction/TokenStreamFile.h"
 
 
 class Parser {
@@ -16,11 +20,30 @@ public:
     void parse(const std::shared_ptr<Predictor> &tokenizer, const std::string &parsing_tree_path,
                const std::string &parsing_output_path);
 
+    // Parses tokens that were already scanned from program, which is only read to locate the errors.
+    // Directed scanning doesn't apply.
+    void parse(const TokenStreamReader &tokens, const std::shared_ptr<SourceBuffer> &program,
+               const std::string &parsing_tree_path, const std::string &parsing_output_path);
+
     static void output_string(const std::string &parsing_output_path, const std::string &output_string);
 
-    std::pair<std::string, std::string> get_next_token(const std::shared_ptr<Predictor> &tokenizer);
+    std::pair<std::string, std::string> get_next_token(TokenLookahead &lookahead);
+
+    // Makes the tokenizer scan only the terminals the parser can accept next (see Predictor::expect()).
+    void set_directed_scanning(bool enabled);
 
 private:
+    // Parses the tokens returned by next_token(), which is given the top of the stack (what the parser expects).
+    void parse(const std::function<std::pair<std::string, std::string>(const std::string &)> &next_token,
+               const std::function<SourcePosition(std::uint64_t)> &locate,
+               const std::string &parsing_tree_path, const std::string &parsing_output_path);
+
+    // Returns where the last token read is, "line L, column C".
+    [[nodiscard]] std::string input_position(const std::function<SourcePosition(std::uint64_t)> &locate) const;
+
+    // Tells the tokenizer the terminals acceptable with top on the stack, before the next token is read.
+    void expect(const std::shared_ptr<Predictor> &tokenizer, const std::string &top);
+
     // ANSI escape codes
     const std::string RED = "\033[31m";
     const std::string GREEN = "\033[32m";
@@ -28,6 +51,11 @@ private:
 
     std::shared_ptr<Table> table;
     std::vector<std::pair<std::string, std::vector<std::string>>> parse_tree_vector{};
+    // the offset of the last token read, located only for the errors
+    std::uint64_t input_offset{};
+    bool directed_scanning{};
+    // the expected kinds for every top of the stack, indexed by the kinds of the tokenizer
+    std::unordered_map<std::string, std::vector<bool>> expected_kinds{};
 };
 
 #endif
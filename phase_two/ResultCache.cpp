@@ -0,0 +1,184 @@
+#include "ResultCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+    std::uint64_t rotate(std::uint64_t x, int bits) {
+        return (x << bits) | (x >> (64 - bits));
+    }
+
+    // the finalizer of MurmurHash3, every input bit flips about half of the output bits
+    std::uint64_t avalanche(std::uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // Writes what is printed to std::cout to a second buffer as well.
+    class TeeBuffer : public std::streambuf {
+    public:
+        TeeBuffer(std::streambuf *first, std::streambuf *second) : first(first), second(second) {}
+
+    protected:
+        int overflow(int c) override {
+            if (c == traits_type::eof()) {
+                return traits_type::not_eof(c);
+            }
+            if (this->first->sputc(static_cast<char>(c)) == traits_type::eof() ||
+                this->second->sputc(static_cast<char>(c)) == traits_type::eof()) {
+                return traits_type::eof();
+            }
+            return c;
+        }
+
+        std::streamsize xsputn(const char *s, std::streamsize n) override {
+            this->first->sputn(s, n);
+            return this->second->sputn(s, n);
+        }
+
+        int sync() override {
+            return this->first->pubsync() | this->second->pubsync();
+        }
+
+    private:
+        std::streambuf *first;
+        std::streambuf *second;
+    };
+
+    // Points std::cout back to its buffer however the parse ends.
+    class CoutRedirect {
+    public:
+        explicit CoutRedirect(std::streambuf *buffer) : previous(std::cout.rdbuf(buffer)) {}
+
+        ~CoutRedirect() { std::cout.rdbuf(this->previous); }
+
+    private:
+        std::streambuf *previous;
+    };
+
+    // Appends the file at path (if there is one) to output through a mapping of it.
+    void replay(const std::string &path, std::ostream &output) {
+        if (!std::filesystem::exists(path)) {
+            return;
+        }
+        std::shared_ptr<SourceBuffer> buffer = SourceBuffer::map_file(path);
+        output.write(buffer->view().data(), static_cast<std::streamsize>(buffer->size()));
+    }
+
+    void replay(const std::string &path, const std::string &output_path) {
+        if (!std::filesystem::exists(path)) {
+            return;
+        }
+        std::ofstream output(output_path, std::ios::app | std::ios::binary);
+        replay(path, output);
+    }
+}
+
+ResultCache::ResultCache(const std::string &directory) {
+    this->directory = directory;
+    std::filesystem::create_directories(directory);
+}
+
+std::string ResultCache::hash(std::string_view bytes) {
+    // two lanes of 64 bits that take the input 8 bytes at a time
+    std::uint64_t a = 0x9e3779b97f4a7c15ULL ^ bytes.size();
+    std::uint64_t b = 0xc2b2ae3d27d4eb4fULL + bytes.size();
+    std::size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes.data() + i, 8);
+        a = rotate(a ^ word, 29) * 0x9e3779b97f4a7c15ULL;
+        b = rotate(b + word * 0x165667b19e3779f9ULL, 31) * 0xc2b2ae3d27d4eb4fULL;
+    }
+    std::uint64_t tail = 0;
+    if (i < bytes.size()) {
+        std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+    }
+    a = rotate(a ^ tail, 29) * 0x9e3779b97f4a7c15ULL;
+    b = rotate(b + tail * 0x165667b19e3779f9ULL, 31) * 0xc2b2ae3d27d4eb4fULL;
+    std::uint64_t high = avalanche(a + b);
+    std::uint64_t low = avalanche(b ^ high);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(32, '0');
+    for (int d = 0; d < 16; d++) {
+        hex[d] = digits[(high >> (60 - 4 * d)) & 0xf];
+        hex[16 + d] = digits[(low >> (60 - 4 * d)) & 0xf];
+    }
+    return hex;
+}
+
+std::string ResultCache::hash_file(const std::string &file_name) {
+    std::shared_ptr<SourceBuffer> buffer = SourceBuffer::map_file(file_name);
+    // a file that can't be mapped is read whole, keeping every byte in the window
+    while (buffer->refill(0)) {
+    }
+    return hash(buffer->view());
+}
+
+std::shared_ptr<TokenStreamReader>
+ResultCache::tokens(const std::string &input_hash, const std::string &lexer_hash,
+                    const std::function<std::shared_ptr<Predictor>()> &make_predictor) {
+    std::string path = this->directory + "/tokens-" + input_hash + "-" + lexer_hash + ".bin";
+    if (std::filesystem::exists(path)) {
+        return std::make_shared<TokenStreamReader>(path);
+    }
+    std::shared_ptr<Predictor> predictor = make_predictor();
+    std::string temporary = temporary_name(path);
+    TokenStreamWriter writer(temporary, predictor->get_token_table());
+    writer.write_all(*predictor);
+    writer.close();
+    if (predictor->get_diagnostics().reported() == 0) {
+        std::filesystem::rename(temporary, path);
+        return std::make_shared<TokenStreamReader>(path);
+    }
+    // the mapping (or the copy without mmap) outlives the file
+    auto tokens = std::make_shared<TokenStreamReader>(temporary);
+    std::filesystem::remove(temporary);
+    return tokens;
+}
+
+void ResultCache::parse(const std::string &input_hash, const std::string &lexer_hash, const std::string &table_hash,
+                        const std::string &parsing_tree_path, const std::string &parsing_output_path,
+                        const std::function<bool(const std::string &, const std::string &)> &parse) {
+    std::string entry = this->directory + "/parse-" + input_hash + "-" + lexer_hash + "-" + table_hash;
+    if (!std::filesystem::exists(entry)) {
+        std::string temporary = temporary_name(entry);
+        std::filesystem::create_directory(temporary);
+        bool keep;
+        try {
+            std::ofstream console(temporary + "/console.txt", std::ios::binary);
+            TeeBuffer tee(std::cout.rdbuf(), console.rdbuf());
+            CoutRedirect redirect(&tee);
+            keep = parse(temporary + "/tree.txt", temporary + "/output.txt");
+        } catch (...) {
+            std::filesystem::remove_all(temporary);
+            throw;
+        }
+        replay(temporary + "/tree.txt", parsing_tree_path);
+        replay(temporary + "/output.txt", parsing_output_path);
+        std::error_code error;
+        if (keep) {
+            // a concurrent run may have stored the same entry first, then this one is dropped
+            std::filesystem::rename(temporary, entry, error);
+        }
+        std::filesystem::remove_all(temporary, error);
+        return;
+    }
+    replay(entry + "/console.txt", std::cout);
+    std::cout.flush();
+    replay(entry + "/tree.txt", parsing_tree_path);
+    replay(entry + "/output.txt", parsing_output_path);
+}
+
+std::string ResultCache::temporary_name(const std::string &path) {
+    static std::mt19937_64 random(std::random_device{}());
+    return path + ".tmp" + std::to_string(random());
+}
@@ -0,0 +1,58 @@
+#ifndef COMPILER_PROJECT_RESULTCACHE_H
+#define COMPILER_PROJECT_RESULTCACHE_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "../phase_one/prediction/Predictor.h"
+#include "../phase_one/prediction/TokenStreamFile.h"
+
+/**
+ * This class is a directory of results addressed by the hashes of what they were computed from, so running the
+ * pipeline again on an unchanged program reads the results back (memory mapped) instead of scanning and parsing it:
+ *  - tokens-<input hash>-<lexer hash>.bin is the token stream of a program (see TokenStreamFile.h),
+ *  - parse-<input hash>-<lexer hash>-<table hash>/ holds what parsing those tokens wrote: tree.txt, output.txt
+ *    and console.txt.
+ * The input and lexer hashes name the token stream as well as its own hash would (it is derived from them alone),
+ * and the parse output also depends on the program itself since the errors give line and column.
+ *
+ * Entries are written under a temporary name and renamed into place, so concurrent runs can share a directory.
+ * A run whose scan reported invalid input isn't stored, the next run reports the errors again.
+ */
+class ResultCache {
+public:
+    // Creates the directory if needed.
+    explicit ResultCache(const std::string &directory);
+
+    // Returns a 128-bit hash of bytes as 32 hex digits. It tells contents apart, it isn't cryptographic.
+    static std::string hash(std::string_view bytes);
+
+    // Returns the hash of the contents of a file.
+    static std::string hash_file(const std::string &file_name);
+
+    /**
+     * Returns the token stream of the program with hash input_hash scanned by the lexer with hash lexer_hash.
+     * On a miss the program is scanned by the Predictor that make_predictor() returns.
+     */
+    std::shared_ptr<TokenStreamReader> tokens(const std::string &input_hash, const std::string &lexer_hash,
+                                              const std::function<std::shared_ptr<Predictor>()> &make_predictor);
+
+    /**
+     * Appends the parse of a program to parsing_tree_path and parsing_output_path and prints it, like
+     * Parser::parse() does. On a miss parse(tree path, output path) runs the parser into the new entry,
+     * it returns whether the scan was free of invalid input (so the entry can be kept).
+     */
+    void parse(const std::string &input_hash, const std::string &lexer_hash, const std::string &table_hash,
+               const std::string &parsing_tree_path, const std::string &parsing_output_path,
+               const std::function<bool(const std::string &, const std::string &)> &parse);
+
+private:
+    // Returns a fresh name next to path to write an entry under.
+    static std::string temporary_name(const std::string &path);
+
+    std::string directory;
+};
+
+
+#endif
@@ -137,6 +137,17 @@ std::vector<std::string> Table::get_rule(const std::string &non_terminal, const
     return this->parsing_table.at(std::make_pair(non_terminal, terminal));
 }
 
+std::vector<std::string> Table::get_expected_terminals(const std::string &non_terminal) {
+    std::vector<std::string> terminals{};
+    for (const auto &terminal: this->rules_obj->get_terminals()) {
+        auto it = this->parsing_table.find(std::make_pair(non_terminal, terminal));
+        if (it != this->parsing_table.end() && !it->second.empty()) {
+            terminals.push_back(terminal);
+        }
+    }
+    return terminals;
+}
+
 void Table::export_to_file(const std::string &file_name) {
     std::ofstream file(file_name);
     if (!file.is_open()) {
@@ -19,6 +19,9 @@ public:
 
     std::vector<std::string> get_rule(const std::string &non_terminal, const std::string &terminal);
 
+    // Returns the terminals with a non-empty cell in the row of non_terminal, the ones the parser can accept there.
+    std::vector<std::string> get_expected_terminals(const std::string &non_terminal);
+
     void build_table();
 
     void print_table();